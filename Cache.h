@@ -17,4 +17,36 @@
 #define L1_READ_TIME 1 // The time it takes to read data from the L1 cache in some unit of time
 #define L1_WRITE_TIME 1 // The time it takes to write data to the L1 cache in some unit of time
 
+/*********************** Virtual memory (only used when built with -DVIRTUAL_MEMORY) *************************/
+
+#define PAGE_SIZE_4K (4 * 1024) // in bytes // Base page size
+#define PAGE_SIZE_2M (2 * 1024 * 1024) // in bytes // Huge page size, mapped by a second level page table entry
+#define PAGE_SIZE_1G (1024 * 1024 * 1024) // in bytes // Huge page size, mapped by a first level page table entry
+#define PAGE_SIZE PAGE_SIZE_4K // The page size used to map the whole DRAM
+
+#define TLB_L1_ENTRIES 16 // Number of translations held by the L1 TLB
+#define TLB_L1_ASSOCIATIVITY 4 // Number of ways in each set of the L1 TLB
+#define TLB_L2_ENTRIES 64 // Number of translations held by the L2 TLB
+#define TLB_L2_ASSOCIATIVITY 8 // Number of ways in each set of the L2 TLB
+#define PWC_ENTRIES 8 // Number of upper level page table entries held by the (fully associative) page-walk cache
+
+#define TLB_L1_TIME 0 // The time it takes to look up the L1 TLB (overlapped with the L1 cache access)
+#define TLB_L2_TIME 5 // The time it takes to look up the L2 TLB after an L1 TLB miss
+
+/*********************** Miss ratio curve (only used when built with -DMRC_SAMPLING) *************************/
+
+#define MRC_SAMPLES 8192 // Maximum number of sampled blocks tracked at once, which bounds the memory used
+#ifdef MRC_EXACT
+#define MRC_INITIAL_RATE 1.0 // make MRC=exact: every block is sampled, so the curve is exact as long as the accessed blocks fit in MRC_SAMPLES (always with this DRAM)
+#else
+#define MRC_INITIAL_RATE 0.01 // Fraction of blocks sampled until MRC_SAMPLES is reached, the rate only goes down after that
+#endif
+#define MRC_BUCKETS (DRAM_SIZE / BLOCK_SIZE) // Largest cache size (in blocks) the curve is estimated for
+#define MRC_PUBLISH_INTERVAL (1024 * 1024) // Number of accesses between two published curves
+
+/*********************** Latency histograms (only used when built with -DLATENCY_HISTOGRAM) *************************/
+
+#define LATENCY_SUB_BITS 5 // Every power of two range of latencies is split in 2^(LATENCY_SUB_BITS - 1) buckets (~3% precision)
+#define LATENCY_WORST 10 // Number of worst offending addresses reported
+
 #endif
@@ -19,6 +19,14 @@ void accessDRAM(uint32_t address, uint8_t *data, uint32_t mode) {
   global time variable based on the mode
   */
 
+#ifdef LATENCY_HISTOGRAM
+  noteLatency(LATENCY_DRAM, mode);
+#endif
+
+#ifdef REGION_STATS
+  noteRegion(REGION_DRAM, address, mode);
+#endif
+
   if (address >= DRAM_SIZE - WORD_SIZE + 1)
     exit(-1);
 
@@ -33,7 +41,12 @@ void accessDRAM(uint32_t address, uint8_t *data, uint32_t mode) {
   }
 }
 
-void initCache() { cache.init = 0; } // Initializes the L1 cache
+void initCache() { // Initializes the L1 cache
+  cache.init = 0;
+#ifdef VIRTUAL_MEMORY
+  initTLB(); // Translations cached for the previous run are flushed as well
+#endif
+}
 
 void accessL1(uint32_t address, uint8_t *data, uint32_t mode) {
   /*
@@ -78,6 +91,14 @@ void accessL1(uint32_t address, uint8_t *data, uint32_t mode) {
     cache.init = 1;
   }
 
+#ifdef VIRTUAL_MEMORY
+  address = translateAddress(address); // Everything below this point is physically addressed
+#endif
+
+#ifdef MRC_SAMPLING
+  sampleMRC(address); // The estimator sees exactly the addresses L1 is accessed with
+#endif
+
   Tag = address / (L1_SIZE / BLOCK_SIZE); // Calculates the tag of the memory address by dividing the address by the size of the cache (L1_SIZE)
   index = (address / BLOCK_SIZE) % (L1_SIZE / BLOCK_SIZE); // Calculates the index of the cache line by dividing the address by the size of a block (BLOCK_SIZE) and then taking the remainder of that division when divided by the size of the cache (L1_SIZE)
   offset = address % BLOCK_SIZE; // Calculates the offset of the memory address by taking the remainder of the address when divided by the size of a block (BLOCK_SIZE)
@@ -149,6 +170,14 @@ void accessL1(uint32_t address, uint8_t *data, uint32_t mode) {
 void accessL2(uint32_t address, uint8_t *data, uint32_t mode) {
   uint32_t index, Tag, offset;
 
+#ifdef LATENCY_HISTOGRAM
+  noteLatency(LATENCY_L2, mode);
+#endif
+
+#ifdef REGION_STATS
+  noteRegion(REGION_L2, address, mode);
+#endif
+
   Tag = address / ((L2_SIZE / (BLOCK_SIZE * ASSOCIATIVITY_L2)) * BLOCK_SIZE);
   index = (address / BLOCK_SIZE) % (L2_SIZE / (BLOCK_SIZE * ASSOCIATIVITY_L2));
   offset = address % BLOCK_SIZE;
@@ -210,10 +239,52 @@ void accessL2(uint32_t address, uint8_t *data, uint32_t mode) {
   }
 }
 
+#ifdef VIRTUAL_MEMORY
+void accessPageTable(uint32_t address, uint8_t *data) { // Page table entries are fetched through L2, bypassing L1
+  uint8_t TempBlock[BLOCK_SIZE];
+  uint32_t index = (address / BLOCK_SIZE) % (L2_SIZE / (BLOCK_SIZE * ASSOCIATIVITY_L2));
+  uint32_t Tag = address / ((L2_SIZE / (BLOCK_SIZE * ASSOCIATIVITY_L2)) * BLOCK_SIZE);
+
+  accessL2(address, TempBlock, MODE_READ);
+
+  // accessL2 hands back a word on a hit but the whole block on a miss, so the entry is taken from the (now resident) line
+  for (int i = 0; i < ASSOCIATIVITY_L2; i++) {
+    if (cache.L2.Lines[index][i].Valid && cache.L2.Lines[index][i].Tag == Tag) {
+      memcpy(data, &(cache.L2.Lines[index][i].Data[address % BLOCK_SIZE]), PTE_SIZE);
+      break;
+    }
+  }
+}
+#endif
+
 void read(uint32_t address, uint8_t *data) { // Calls accessL1 to perform a read operation from the cache
+#ifdef LATENCY_HISTOGRAM
+  startLatency(time);
+#endif
+#ifdef REGION_STATS
+  startRegion(address, time);
+#endif
   accessL1(address, data, MODE_READ);
+#ifdef LATENCY_HISTOGRAM
+  recordLatency(address, MODE_READ, time);
+#endif
+#ifdef REGION_STATS
+  endRegion(MODE_READ, time);
+#endif
 }
 
 void write(uint32_t address, uint8_t *data) { // Calls accessL1 to perform a write operation to the cache
+#ifdef LATENCY_HISTOGRAM
+  startLatency(time);
+#endif
+#ifdef REGION_STATS
+  startRegion(address, time);
+#endif
   accessL1(address, data, MODE_WRITE);
+#ifdef LATENCY_HISTOGRAM
+  recordLatency(address, MODE_WRITE, time);
+#endif
+#ifdef REGION_STATS
+  endRegion(MODE_WRITE, time);
+#endif
 }
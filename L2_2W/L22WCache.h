@@ -7,6 +7,22 @@
 #include <stdint.h>
 #include "../Cache.h"
 
+#ifdef VIRTUAL_MEMORY
+#include "../VM/TLB.h"
+#endif
+
+#ifdef MRC_SAMPLING
+#include "../MRC/Shards.h"
+#endif
+
+#ifdef LATENCY_HISTOGRAM
+#include "../Latency/Latency.h"
+#endif
+
+#ifdef REGION_STATS
+#include "../Region/Region.h"
+#endif
+
 #define ASSOCIATIVITY_L2 2
 
 void resetTime();
@@ -0,0 +1,168 @@
+#include "Latency.h"
+
+Latency latency;
+
+static const char *levelNames[LATENCY_LEVELS] = {"L1", "L2", "DRAM"};
+
+/*********************** Buckets *************************/
+
+static uint32_t bucketOf(uint32_t value) {
+  if (value < 2 * LATENCY_HALF_BUCKETS)
+    return value;
+
+  uint32_t shift = (31 - __builtin_clz(value)) - (LATENCY_SUB_BITS - 1); // keeps LATENCY_SUB_BITS significant bits
+  return shift * LATENCY_HALF_BUCKETS + (value >> shift);
+}
+
+static uint64_t bucketStart(uint32_t bucket) { // Lowest latency falling in the bucket
+  if (bucket < 2 * LATENCY_HALF_BUCKETS)
+    return bucket;
+
+  uint32_t shift = bucket / LATENCY_HALF_BUCKETS - 1;
+  return (uint64_t)(bucket - shift * LATENCY_HALF_BUCKETS) << shift;
+}
+
+static uint64_t percentile(const LatencyHistogram *histogram, double fraction) {
+  /* Highest latency of the bucket holding the given fraction of the accesses, as HDR histograms report it */
+
+  uint64_t rank = (uint64_t)(fraction * histogram->Count + 0.5);
+  uint64_t seen = 0;
+
+  if (rank == 0)
+    rank = 1;
+
+  for (uint32_t bucket = 0; bucket < LATENCY_BUCKETS; bucket++) {
+    seen += histogram->Buckets[bucket];
+    if (seen >= rank) {
+      uint64_t end = bucketStart(bucket + 1) - 1;
+      return end < histogram->Max ? end : histogram->Max;
+    }
+  }
+  return histogram->Max;
+}
+
+static void addLatency(LatencyHistogram *histogram, uint32_t value) {
+  histogram->Count++;
+  histogram->Total += value;
+  if (value > histogram->Max)
+    histogram->Max = value;
+  histogram->Buckets[bucketOf(value)]++;
+}
+
+/*********************** Recording *************************/
+
+void startLatency(uint32_t time) {
+  latency.start = time;
+  latency.level = LATENCY_L1;
+  latency.writeback = 0;
+  latency.translated = 0;
+  latency.translation = 0;
+}
+
+void noteLatency(uint32_t level, uint32_t mode) {
+  if (latency.translating) // page table reads belong to the translation
+    return;
+  if (mode == MODE_WRITE)
+    latency.writeback = 1;
+  else if (level > latency.level)
+    latency.level = level;
+}
+
+static void recordOffender(uint32_t address, uint32_t mode, uint32_t value) {
+  /* Keeps the LATENCY_WORST slowest addresses, each address at most once with its worst access */
+
+  int position = -1;
+
+  for (uint32_t i = 0; i < latency.worstCount; i++) {
+    if (latency.Worst[i].Address == address) {
+      if (latency.Worst[i].Latency >= value)
+        return;
+      position = i;
+      break;
+    }
+  }
+
+  if (position == -1) {
+    if (latency.worstCount == LATENCY_WORST && latency.Worst[LATENCY_WORST - 1].Latency >= value)
+      return;
+    position = latency.worstCount < LATENCY_WORST ? latency.worstCount++ : LATENCY_WORST - 1;
+  }
+
+  while (position > 0 && latency.Worst[position - 1].Latency < value) { // insertion sort towards the front
+    latency.Worst[position] = latency.Worst[position - 1];
+    position--;
+  }
+
+  latency.Worst[position].Address = address;
+  latency.Worst[position].Mode = mode;
+  latency.Worst[position].Latency = value;
+  latency.Worst[position].Level = latency.level;
+  latency.Worst[position].Writeback = latency.writeback;
+  latency.Worst[position].Translation = latency.translation;
+}
+
+void recordLatency(uint32_t address, uint32_t mode, uint32_t time) {
+  uint32_t value = time - latency.start;
+
+  addLatency(&latency.Histograms[mode == MODE_READ][latency.level][latency.writeback], value - latency.translation);
+  if (latency.translated)
+    addLatency(&latency.Translations[mode == MODE_READ], latency.translation);
+  addLatency(&latency.Totals[mode == MODE_READ], value);
+
+  if (latency.worstCount < LATENCY_WORST || value > latency.Worst[LATENCY_WORST - 1].Latency)
+    recordOffender(address, mode, value);
+}
+
+void startTranslationLatency(uint32_t time) {
+  latency.translating = 1;
+  latency.translationStart = time;
+}
+
+void endTranslationLatency(uint32_t time) {
+  latency.translating = 0;
+  latency.translated = 1;
+  latency.translation += time - latency.translationStart;
+}
+
+/*********************** Report *************************/
+
+static void printHistogram(const char *name, const LatencyHistogram *histogram) {
+  if (histogram->Count == 0)
+    return;
+
+  printf("%-22s Count %llu; Mean %.2f; p50 %llu; p99 %llu; p99.9 %llu; Max %u\n", name,
+         (unsigned long long)histogram->Count, (double)histogram->Total / histogram->Count,
+         (unsigned long long)percentile(histogram, 0.5), (unsigned long long)percentile(histogram, 0.99),
+         (unsigned long long)percentile(histogram, 0.999), histogram->Max);
+}
+
+void printLatencyReport() {
+  char name[64];
+
+  printf("\nAccess latency\n");
+
+  for (int mode = 1; mode >= 0; mode--) {
+    const char *op = mode ? "Read" : "Write";
+
+    for (int level = 0; level < LATENCY_LEVELS; level++) {
+      for (int writeback = 0; writeback < 2; writeback++) {
+        snprintf(name, sizeof(name), "%s %s%s", op, levelNames[level], writeback ? " + writeback" : "");
+        printHistogram(name, &latency.Histograms[mode][level][writeback]);
+      }
+    }
+    snprintf(name, sizeof(name), "%s translation", op);
+    printHistogram(name, &latency.Translations[mode]);
+    snprintf(name, sizeof(name), "%s (all)", op);
+    printHistogram(name, &latency.Totals[mode]);
+  }
+
+  printf("\nWorst offending addresses\n");
+  for (uint32_t i = 0; i < latency.worstCount; i++) {
+    LatencyOffender *Worst = &latency.Worst[i];
+    printf("%s; Address %u; Latency %u; Served by %s%s", Worst->Mode == MODE_READ ? "Read" : "Write", Worst->Address,
+           Worst->Latency, levelNames[Worst->Level], Worst->Writeback ? " + writeback" : "");
+    if (Worst->Translation != 0)
+      printf("; Translation %u", Worst->Translation);
+    printf("\n");
+  }
+}
@@ -0,0 +1,68 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "../Cache.h"
+
+/*
+Per-access latency histograms. read() and write() bracket every access with
+startLatency / recordLatency, and the levels below L1 report themselves with
+noteLatency, so each access is classified by its operation, the level that
+served it and whether it caused a write-back on the way. With virtual memory
+the address translation is bracketed too: the page walk is kept out of that
+classification, its cycles go to a translation class of their own, and the
+level classes only hold the data access. Histograms are
+log-bucketed (HDR style): latencies below 2^LATENCY_SUB_BITS are exact, above
+that every power of two range has the same number of buckets
+*/
+
+#define LATENCY_L1 0
+#define LATENCY_L2 1
+#define LATENCY_DRAM 2
+#define LATENCY_LEVELS 3
+
+#define LATENCY_HALF_BUCKETS (1 << (LATENCY_SUB_BITS - 1))
+#define LATENCY_BUCKETS ((32 - LATENCY_SUB_BITS + 2) * LATENCY_HALF_BUCKETS) // Enough for any uint32_t latency
+
+void startLatency(uint32_t); // Starts timing an access at the given time
+void noteLatency(uint32_t, uint32_t); // A level below L1 was accessed (LATENCY_L2 / LATENCY_DRAM, mode)
+void recordLatency(uint32_t, uint32_t, uint32_t); // Ends the access (address, mode, time) and adds it to its histogram
+void startTranslationLatency(uint32_t); // Address translation starts at the given time, the levels it reaches are not noted
+void endTranslationLatency(uint32_t); // Address translation ends at the given time
+void printLatencyReport(); // Prints p50 / p99 / p99.9 per class and the worst offending addresses
+
+typedef struct LatencyHistogram {
+  uint64_t Count;
+  uint64_t Total;
+  uint32_t Max;
+  uint64_t Buckets[LATENCY_BUCKETS];
+} LatencyHistogram;
+
+typedef struct LatencyOffender {
+  uint32_t Address;
+  uint32_t Mode;
+  uint32_t Latency;
+  uint32_t Level;
+  uint32_t Writeback;
+  uint32_t Translation; // cycles spent translating the address
+} LatencyOffender;
+
+typedef struct Latency {
+  uint32_t start; // time the current access started
+  uint32_t level; // deepest level that served a read for the current access
+  uint32_t writeback; // the current access wrote a dirty block back
+  uint32_t translating; // a page walk is in progress, the levels it reaches are not noted
+  uint32_t translated; // the current access was translated
+  uint32_t translationStart;
+  uint32_t translation; // cycles the current access spent translating its address
+  LatencyHistogram Histograms[2][LATENCY_LEVELS][2]; // [mode][level][writeback], data access only
+  LatencyHistogram Translations[2]; // [mode]
+  LatencyHistogram Totals[2]; // [mode], whole accesses
+  LatencyOffender Worst[LATENCY_WORST]; // sorted by decreasing latency
+  uint32_t worstCount;
+} Latency;
+
+#endif
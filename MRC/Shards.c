@@ -0,0 +1,255 @@
+#include "Shards.h"
+
+MRC mrc = {.untilPublish = 1}; // the first access is due, and initializes the estimator
+
+/*********************** Fenwick tree over timestamps *************************/
+
+static void fenwickAdd(uint32_t position, int32_t delta) {
+  for (; position <= mrc.window; position += position & -position)
+    mrc.Fenwick[position] += delta;
+}
+
+static uint32_t fenwickPrefix(uint32_t position) { // Tracked blocks last accessed at or before position
+  uint32_t sum = 0;
+  for (; position > 0; position -= position & -position)
+    sum += mrc.Fenwick[position];
+  return sum;
+}
+
+static int compareTimes(const void *a, const void *b) {
+  uint32_t timeA = mrc.Entries[*(const uint32_t *)a].Time;
+  uint32_t timeB = mrc.Entries[*(const uint32_t *)b].Time;
+  return (timeA > timeB) - (timeA < timeB);
+}
+
+static void compactTimes() {
+  /*
+  Renumbers the timestamps 1..count keeping their order, so the clock never runs
+  past the window. The window then shrinks or grows to a few times the tracked
+  blocks, which keeps the Fenwick tree walks short while few blocks are tracked
+  */
+
+  static uint32_t order[MRC_SAMPLES];
+
+  for (uint32_t i = 0; i < mrc.count; i++)
+    order[i] = i;
+  qsort(order, mrc.count, sizeof(uint32_t), compareTimes);
+
+  memset(mrc.Fenwick, 0, (mrc.window + 1) * sizeof(uint32_t)); // nothing was marked past the old window
+  mrc.window = 4 * mrc.count < MRC_MIN_WINDOW ? MRC_MIN_WINDOW : 4 * mrc.count;
+  for (uint32_t i = 0; i < mrc.count; i++) {
+    mrc.Entries[order[i]].Time = i + 1;
+    fenwickAdd(i + 1, 1);
+  }
+  mrc.clock = mrc.count;
+}
+
+/*********************** Block table *************************/
+
+static uint32_t homeSlot(uint32_t block) { // Low bits of the mix, the sampling hash only constrains the top ones
+  return mixMRC(block) % MRC_TABLE_SIZE;
+}
+
+static uint32_t findSlot(uint32_t block) { // Slot holding the block, or the empty slot where it would go
+  uint32_t slot = homeSlot(block);
+  while (mrc.Table[slot] != -1 && mrc.Entries[mrc.Table[slot]].Block != block)
+    slot = (slot + 1) % MRC_TABLE_SIZE;
+  return slot;
+}
+
+static void removeSlot(uint32_t slot) { // Linear probing deletion, shifting back the entries that probed past the slot
+  uint32_t next = slot;
+
+  while (1) {
+    next = (next + 1) % MRC_TABLE_SIZE;
+    if (mrc.Table[next] == -1)
+      break;
+
+    uint32_t home = homeSlot(mrc.Entries[mrc.Table[next]].Block);
+    if ((next > slot && (home <= slot || home > next)) || (next < slot && home <= slot && home > next)) {
+      mrc.Table[slot] = mrc.Table[next];
+      slot = next;
+    }
+  }
+
+  mrc.Table[slot] = -1;
+}
+
+/*********************** Max-heap by hash *************************/
+
+static void heapSwap(uint32_t a, uint32_t b) {
+  uint32_t entry = mrc.Heap[a];
+  mrc.Heap[a] = mrc.Heap[b];
+  mrc.Heap[b] = entry;
+  mrc.Entries[mrc.Heap[a]].HeapPos = a;
+  mrc.Entries[mrc.Heap[b]].HeapPos = b;
+}
+
+static uint32_t heapHash(uint32_t position) { return mrc.Entries[mrc.Heap[position]].Hash; }
+
+static void siftUp(uint32_t position) {
+  while (position > 0 && heapHash((position - 1) / 2) < heapHash(position)) {
+    heapSwap(position, (position - 1) / 2);
+    position = (position - 1) / 2;
+  }
+}
+
+static void siftDown(uint32_t position) {
+  while (1) {
+    uint32_t largest = position;
+    uint32_t left = 2 * position + 1, right = 2 * position + 2;
+
+    if (left < mrc.count && heapHash(left) > heapHash(largest))
+      largest = left;
+    if (right < mrc.count && heapHash(right) > heapHash(largest))
+      largest = right;
+    if (largest == position)
+      return;
+
+    heapSwap(position, largest);
+    position = largest;
+  }
+}
+
+/*********************** Tracked blocks *************************/
+
+static void insertEntry(uint32_t slot, uint32_t block, uint32_t hash) {
+  uint32_t index = mrc.count++;
+  MRCEntry *Entry = &mrc.Entries[index];
+
+  Entry->Block = block;
+  Entry->Hash = hash;
+  Entry->Time = mrc.clock;
+  Entry->HeapPos = index;
+  mrc.Heap[index] = index;
+  mrc.Table[slot] = index;
+
+  fenwickAdd(Entry->Time, 1);
+  siftUp(index);
+}
+
+static void evictLargest() {
+  /* Drops the tracked block with the largest hash, moving the last entry into its place */
+
+  uint32_t index = mrc.Heap[0];
+  uint32_t last = mrc.count - 1;
+
+  fenwickAdd(mrc.Entries[index].Time, -1);
+  removeSlot(findSlot(mrc.Entries[index].Block));
+
+  heapSwap(0, last);
+  mrc.count--;
+  siftDown(0);
+
+  if (index != last) {
+    mrc.Table[findSlot(mrc.Entries[last].Block)] = index;
+    mrc.Entries[index] = mrc.Entries[last];
+    mrc.Heap[mrc.Entries[index].HeapPos] = index;
+  }
+}
+
+/*********************** Estimator *************************/
+
+void initMRC() {
+  memset(&mrc, 0, sizeof(mrc));
+  memset(mrc.Table, -1, sizeof(mrc.Table));
+  mrc.threshold = MRC_INITIAL_RATE * MRC_MODULUS;
+  mrc.window = MRC_MIN_WINDOW;
+  mrc.untilPublish = MRC_PUBLISH_INTERVAL;
+  mrc.init = 1;
+}
+
+void recordMRC(uint32_t address, uint32_t hash) {
+  /*
+  Only the accesses to sampled blocks get here (plus one access per published
+  curve). Their reuse distance is the number of distinct sampled blocks accessed
+  since the previous access to the same block, scaled by 1/R, and every sample
+  counts with weight 1/R in the histogram
+
+  address : The byte address the L1 cache is accessed with
+  hash : The sampling hash of its block
+  */
+
+  uint32_t block = address / BLOCK_SIZE;
+
+  if (!mrc.init) { // The first access lands here whatever its hash, counted against a fresh countdown
+    initMRC();
+    mrc.untilPublish--;
+  }
+
+  if (mrc.untilPublish == 0)
+    publishMRC();
+
+  if (hash >= mrc.threshold)
+    return;
+
+  double rate = (double)mrc.threshold / MRC_MODULUS;
+  uint32_t slot = findSlot(block);
+
+  mrc.sampled++;
+  if (mrc.clock == mrc.window)
+    compactTimes();
+  mrc.clock++;
+
+  if (mrc.Table[slot] != -1) { // reuse
+    MRCEntry *Entry = &mrc.Entries[mrc.Table[slot]];
+    double distance = (mrc.count - fenwickPrefix(Entry->Time)) / rate;
+
+    mrc.Histogram[distance < MRC_BUCKETS ? (uint32_t)distance : MRC_BUCKETS] += 1 / rate;
+
+    fenwickAdd(Entry->Time, -1);
+    Entry->Time = mrc.clock;
+    fenwickAdd(Entry->Time, 1);
+    return;
+  }
+
+  mrc.Cold += 1 / rate; // first access to the block
+
+  if (mrc.count == MRC_SAMPLES) { // Lowers the threshold to the largest hash instead of growing
+    uint32_t largest = mrc.Entries[mrc.Heap[0]].Hash;
+
+    mrc.threshold = hash < largest ? largest : hash;
+    while (mrc.count > 0 && mrc.Entries[mrc.Heap[0]].Hash >= mrc.threshold)
+      evictLargest();
+    if (hash >= mrc.threshold)
+      return;
+    slot = findSlot(block); // evictions move entries around the table
+  }
+
+  insertEntry(slot, block, hash);
+}
+
+void publishMRC() {
+  /*
+  miss ratio(c) = (cold + weight of reuse distances >= c) / accesses. The sampled
+  weights do not add up to the number of accesses exactly, the difference is
+  put on distance 0 (SHARDS_adj), which mostly corrects the small sizes
+  */
+
+  if (!mrc.init) // nothing was accessed yet
+    initMRC();
+  mrc.accesses += MRC_PUBLISH_INTERVAL - mrc.untilPublish; // the accesses since the previous curve
+  mrc.untilPublish = MRC_PUBLISH_INTERVAL;
+
+  double total = mrc.accesses ? (double)mrc.accesses : 1;
+  double misses = mrc.Cold;
+  double sum = mrc.Cold;
+
+  for (int bucket = 0; bucket <= MRC_BUCKETS; bucket++)
+    sum += mrc.Histogram[bucket];
+
+  for (int size = MRC_BUCKETS; size >= 0; size--) {
+    misses += mrc.Histogram[size];
+    double ratio = (size == 0 ? misses + (total - sum) : misses) / total;
+    mrc.Published[size] = ratio < 0 ? 0 : (ratio > 1 ? 1 : ratio);
+  }
+}
+
+void printMRC() {
+  publishMRC();
+
+  printf("\nMiss ratio curve (%llu accesses, %llu sampled, sampling rate %.4f, %u blocks tracked)\n",
+         (unsigned long long)mrc.accesses, (unsigned long long)mrc.sampled, (double)mrc.threshold / MRC_MODULUS, mrc.count);
+  for (uint32_t size = 1; size <= MRC_BUCKETS; size *= 2)
+    printf("Cache size %u blocks; Miss ratio %.4f\n", size, mrc.Published[size]);
+}
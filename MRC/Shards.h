@@ -0,0 +1,83 @@
+#ifndef SHARDS_H
+#define SHARDS_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "../Cache.h"
+
+/*
+Online miss ratio curve estimation with fixed-size SHARDS sampling. Blocks are
+sampled when the hash of their block number is below a threshold T, which makes
+the sample a spatial one: a sampled block is seen on every access. Reuse
+distances are measured between sampled blocks only and scaled by 1/R, where
+R = T / MRC_MODULUS is the current sampling rate. Once MRC_SAMPLES blocks are
+tracked, the block with the largest hash is evicted and T drops to its hash,
+so memory stays constant however long the trace is
+*/
+
+#define MRC_MODULUS (1 << 24) // Hash values are taken modulo this, the threshold is compared against them
+#define MRC_TABLE_SIZE (2 * MRC_SAMPLES) // Open addressing table from block number to tracked entry
+#define MRC_WINDOW (4 * MRC_SAMPLES) // Largest window: timestamps are renumbered when the clock reaches the current one
+#define MRC_MIN_WINDOW 64 // Smallest window, the window is four times the tracked blocks otherwise
+
+void initMRC(); // Forgets every sampled block, the curve and the counters
+void recordMRC(uint32_t, uint32_t); // Slow path of sampleMRC: a sampled block or a due curve
+void publishMRC(); // Recomputes the published curve from the current histogram
+void printMRC(); // Publishes and prints the curve for power of two cache sizes
+
+typedef struct MRCEntry {
+  uint32_t Block;
+  uint32_t Hash;
+  uint32_t Time; // timestamp of the last access, its position in the Fenwick tree
+  uint32_t HeapPos;
+} MRCEntry;
+
+typedef struct MRC {
+  uint32_t init;
+  uint32_t threshold; // blocks with a hash below this are sampled
+  uint32_t count; // blocks currently tracked
+  uint32_t clock; // timestamp of the last sampled access
+  uint32_t window; // timestamps are renumbered when the clock reaches this
+  uint32_t untilPublish; // accesses left before the next curve is due
+  uint64_t accesses; // every access, sampled or not, counted when a curve is published
+  uint64_t sampled;
+  MRCEntry Entries[MRC_SAMPLES];
+  int32_t Table[MRC_TABLE_SIZE]; // entry index or -1
+  uint32_t Heap[MRC_SAMPLES]; // max-heap of entry indices by hash
+  uint32_t Fenwick[MRC_WINDOW + 1]; // one mark per tracked block, at its last access time
+  double Histogram[MRC_BUCKETS + 1]; // weighted reuse distances, the last bucket holds larger ones
+  double Cold; // weight of first accesses to a sampled block
+  double Published[MRC_BUCKETS + 1]; // miss ratio of a fully associative LRU cache of every size, in blocks
+} MRC;
+
+extern MRC mrc;
+
+static inline uint32_t mixMRC(uint32_t block) { // murmur3 finalizer, every output bit depends on every block bit
+  block ^= block >> 16;
+  block *= 0x85EBCA6B;
+  block ^= block >> 13;
+  block *= 0xC2B2AE35;
+  block ^= block >> 16;
+  return block;
+}
+
+static inline uint32_t hashMRC(uint32_t block) { // Sampling hash in [0, MRC_MODULUS), the top bits of the mix
+  return mixMRC(block) >> 8;
+}
+
+static inline void sampleMRC(uint32_t address) {
+  /*
+  Feeds one byte address of the access stream to the estimator. Inlined into the
+  access path: unsampled blocks only cost a hash, a compare and a countdown, which
+  keeps the estimator cheap enough to leave on for whole replays
+  */
+
+  uint32_t hash = hashMRC(address / BLOCK_SIZE);
+
+  if (--mrc.untilPublish == 0 || hash < mrc.threshold)
+    recordMRC(address, hash);
+}
+
+#endif
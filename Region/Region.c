@@ -0,0 +1,205 @@
+#include "Region.h"
+
+Regions regions = {.labelCount = 1, .Labels = {{.Name = "unmapped"}}};
+
+/*********************** Region map *************************/
+
+static int findLabel(const char *name) {
+  for (uint32_t i = 0; i < regions.labelCount; i++) {
+    if (strcmp(regions.Labels[i].Name, name) == 0)
+      return i;
+  }
+  return -1;
+}
+
+static int compareRanges(const void *a, const void *b) {
+  const RegionRange *rangeA = a, *rangeB = b;
+  return (rangeA->Start > rangeB->Start) - (rangeA->Start < rangeB->Start);
+}
+
+int loadRegions(const char *path) {
+  char line[256], name[REGION_LABEL_SIZE];
+  long start, end;
+  uint32_t number = 0;
+  FILE *file = fopen(path, "r");
+
+  if (file == NULL) {
+    fprintf(stderr, "cannot open region file %s\n", path);
+    return -1;
+  }
+
+  while (fgets(line, sizeof(line), file) != NULL) {
+    char *comment = strchr(line, '#');
+    char *first = line;
+
+    number++;
+    if (comment != NULL)
+      *comment = '\0';
+    while (*first == ' ' || *first == '\t')
+      first++;
+    if (*first == '\n' || *first == '\r' || *first == '\0')
+      continue;
+
+    if (sscanf(first, "%li %li %31s", &start, &end, name) != 3 || start < 0 || start >= end || end > 0x100000000L) {
+      fprintf(stderr, "%s:%u: expected \"<start> <end> <label>\" with start < end\n", path, number);
+      fclose(file);
+      return -1;
+    }
+
+    int label = findLabel(name);
+    if (label == -1) {
+      if (regions.labelCount == REGION_MAX_LABELS) {
+        fprintf(stderr, "%s:%u: more than %d labels\n", path, number, REGION_MAX_LABELS);
+        fclose(file);
+        return -1;
+      }
+      label = regions.labelCount++;
+      strcpy(regions.Labels[label].Name, name);
+    }
+
+    if (regions.rangeCount == REGION_MAX_RANGES) {
+      fprintf(stderr, "%s:%u: more than %d ranges\n", path, number, REGION_MAX_RANGES);
+      fclose(file);
+      return -1;
+    }
+    regions.Ranges[regions.rangeCount].Start = start;
+    regions.Ranges[regions.rangeCount].End = end - 1; // inclusive, so a range can reach the top of the address space
+    regions.Ranges[regions.rangeCount].Label = label;
+    regions.rangeCount++;
+  }
+  fclose(file);
+
+  qsort(regions.Ranges, regions.rangeCount, sizeof(RegionRange), compareRanges);
+  for (uint32_t i = 1; i < regions.rangeCount; i++) {
+    if (regions.Ranges[i].Start <= regions.Ranges[i - 1].End) {
+      fprintf(stderr, "%s: ranges of %s and %s overlap\n", path, regions.Labels[regions.Ranges[i - 1].Label].Name,
+              regions.Labels[regions.Ranges[i].Label].Name);
+      return -1;
+    }
+  }
+
+  regions.last = 0;
+  return 0;
+}
+
+int selectRegions(const char *list) {
+  char name[REGION_LABEL_SIZE];
+
+  regions.filtering = 1;
+  while (*list != '\0') {
+    size_t length = strcspn(list, ",");
+    if (length >= REGION_LABEL_SIZE)
+      return -1;
+
+    memcpy(name, list, length);
+    name[length] = '\0';
+
+    int label = findLabel(name);
+    if (label == -1)
+      return -1;
+    regions.Labels[label].Selected = 1;
+
+    list += length;
+    if (*list == ',')
+      list++;
+  }
+  return 0;
+}
+
+uint32_t findRegion(uint32_t address) {
+  RegionRange *Range = &regions.Ranges[regions.last];
+  uint32_t low = 0, high = regions.rangeCount;
+
+  if (regions.rangeCount == 0)
+    return REGION_UNMAPPED;
+  if (Range->Start <= address && address <= Range->End) // Accesses mostly stay in the same range
+    return Range->Label;
+
+  while (low < high) { // first range starting after the address
+    uint32_t middle = low + (high - low) / 2;
+    if (regions.Ranges[middle].Start <= address)
+      low = middle + 1;
+    else
+      high = middle;
+  }
+
+  if (low == 0 || regions.Ranges[low - 1].End < address)
+    return REGION_UNMAPPED;
+
+  regions.last = low - 1;
+  return regions.Ranges[low - 1].Label;
+}
+
+int regionSelected(uint32_t address) {
+  return !regions.filtering || regions.Labels[findRegion(address)].Selected;
+}
+
+/*********************** Attribution *************************/
+
+void startRegion(uint32_t address, uint32_t time) {
+  regions.label = findRegion(address);
+  regions.start = time;
+  regions.l2Read = 0;
+  regions.dramRead = 0;
+  regions.translation = 0;
+}
+
+void noteRegion(uint32_t level, uint32_t address, uint32_t mode) {
+  if (regions.translating) // page table reads belong to the translation
+    return;
+  if (mode == MODE_WRITE) // the victim block's region caused this traffic by dirtying it
+    regions.Labels[findRegion(address)].Stats.Writebacks++;
+  else if (level == REGION_L2)
+    regions.l2Read = 1;
+  else
+    regions.dramRead = 1;
+}
+
+void endRegion(uint32_t mode, uint32_t time) {
+  RegionStats *Stats = &regions.Labels[regions.label].Stats;
+
+  if (mode == MODE_READ)
+    Stats->Reads++;
+  else
+    Stats->Writes++;
+  Stats->L1Misses += regions.l2Read || regions.dramRead;
+  Stats->DRAMReads += regions.dramRead;
+  Stats->Cycles += time - regions.start;
+  Stats->TranslationCycles += regions.translation;
+}
+
+void startTranslationRegion(uint32_t time) {
+  regions.translating = 1;
+  regions.translationStart = time;
+}
+
+void endTranslationRegion(uint32_t time) {
+  regions.translating = 0;
+  regions.translation += time - regions.translationStart;
+}
+
+void printRegionReport() {
+  uint64_t cycles = 0;
+
+  for (uint32_t i = 0; i < regions.labelCount; i++)
+    cycles += regions.Labels[i].Stats.Cycles;
+
+  printf("\nRegions\n");
+  for (uint32_t i = 0; i < regions.labelCount; i++) {
+    RegionStats *Stats = &regions.Labels[i].Stats;
+    uint64_t accesses = Stats->Reads + Stats->Writes;
+
+    if (accesses == 0 && Stats->Writebacks == 0)
+      continue;
+
+    printf("%s; Reads %llu; Writes %llu; L1 hits %llu; L1 misses %llu; DRAM reads %llu; Writebacks %llu; Cycles %llu (%.1f%%)",
+           regions.Labels[i].Name, (unsigned long long)Stats->Reads, (unsigned long long)Stats->Writes,
+           (unsigned long long)(accesses - Stats->L1Misses), (unsigned long long)Stats->L1Misses,
+           (unsigned long long)Stats->DRAMReads, (unsigned long long)Stats->Writebacks, (unsigned long long)Stats->Cycles,
+           cycles ? 100.0 * Stats->Cycles / cycles : 0.0);
+#ifdef VIRTUAL_MEMORY
+    printf("; Translation cycles %llu", (unsigned long long)Stats->TranslationCycles);
+#endif
+    printf("\n");
+  }
+}
@@ -0,0 +1,81 @@
+#ifndef REGION_H
+#define REGION_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "../Cache.h"
+
+/*
+Per-region attribution. A region file lists address ranges with a label, one
+per line, as "<start> <end> <label>" (end exclusive, decimal or 0x hex, '#'
+starts a comment). Several ranges may share a label, e.g. every mmap'd file
+of a kind, and the statistics are kept per label. Addresses outside every
+range belong to the "unmapped" label. A write-back is counted in the region
+of the dirty block it writes, whoever evicted it, while its cycles stay with
+the access that waited for it. With virtual memory, translation cycles are
+kept apart and the page table reads are neither misses nor DRAM reads. The
+ranges are kept sorted, so an access is tagged with a binary search, skipped
+when it falls in the same range as the previous access
+*/
+
+#define REGION_MAX_RANGES 4096
+#define REGION_MAX_LABELS 64
+#define REGION_LABEL_SIZE 32
+#define REGION_UNMAPPED 0 // Label index of the addresses outside every range
+
+#define REGION_L2 1
+#define REGION_DRAM 2
+
+int loadRegions(const char *); // Reads a region file, -1 (with a message on stderr) if it is malformed
+int selectRegions(const char *); // Restricts regionSelected to a comma separated list of labels, -1 on an unknown label
+uint32_t findRegion(uint32_t); // Label index of a byte address
+int regionSelected(uint32_t); // Whether the address belongs to a selected label (every label when none were selected)
+
+void startRegion(uint32_t, uint32_t); // Starts attributing an access (address, time)
+void noteRegion(uint32_t, uint32_t, uint32_t); // A level below L1 was accessed (REGION_L2 / REGION_DRAM, block address, mode)
+void endRegion(uint32_t, uint32_t); // Ends the access (mode, time) and charges it to its label
+void startTranslationRegion(uint32_t); // Address translation starts at the given time, the levels it reaches are not noted
+void endTranslationRegion(uint32_t); // Address translation ends at the given time
+void printRegionReport(); // Prints hits, misses, write-backs and cycles of every label
+
+typedef struct RegionRange {
+  uint32_t Start;
+  uint32_t End;
+  uint32_t Label;
+} RegionRange;
+
+typedef struct RegionStats {
+  uint64_t Reads;
+  uint64_t Writes;
+  uint64_t L1Misses; // accesses that read a block from below L1
+  uint64_t DRAMReads; // accesses that read a block from DRAM
+  uint64_t Writebacks; // dirty blocks of the region written to a lower level
+  uint64_t Cycles;
+  uint64_t TranslationCycles; // part of Cycles spent translating addresses
+} RegionStats;
+
+typedef struct RegionLabel {
+  char Name[REGION_LABEL_SIZE];
+  uint32_t Selected;
+  RegionStats Stats;
+} RegionLabel;
+
+typedef struct Regions {
+  uint32_t rangeCount;
+  uint32_t labelCount;
+  uint32_t filtering; // selectRegions was called
+  uint32_t last; // range of the previous lookup
+  RegionRange Ranges[REGION_MAX_RANGES];
+  RegionLabel Labels[REGION_MAX_LABELS];
+
+  uint32_t label; // label of the current access
+  uint32_t start; // time the current access started
+  uint32_t l2Read, dramRead; // what the current access read below L1
+  uint32_t translating; // a page walk is in progress, the levels it reaches are not noted
+  uint32_t translationStart;
+  uint32_t translation; // cycles the current access spent translating its address
+} Regions;
+
+#endif
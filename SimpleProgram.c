@@ -46,6 +46,22 @@ int main() {
       printf("Write; Address %d; Value %d; Time %d\n", address, address, clock1);
     }
   }
+
+#ifdef VIRTUAL_MEMORY
+  printTLBStats();
+#endif
+
+#ifdef MRC_SAMPLING
+  printMRC();
+#endif
+
+#ifdef LATENCY_HISTOGRAM
+  printLatencyReport();
+#endif
+
+#ifdef REGION_STATS
+  printRegionReport();
+#endif
   
   return 0;
 }
\ No newline at end of file
@@ -0,0 +1,242 @@
+#ifndef CACHELEVEL_HPP
+#define CACHELEVEL_HPP
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include "../Cache.h"
+
+/*
+Compile-time specialized memory hierarchy. Every level knows its geometry as
+template parameters, so the tag / index / offset math folds into shifts and
+masks, and the levels are chained by type (Hierarchy<L1, L2, Memory>) so a
+read or a write is a single inlined call path instead of a run-time switch
+on the mode. Reads and writes are separate instantiations of access<Mode, Bytes>.
+
+Timing follows the C hierarchies: every access to a level costs its read or
+write time whether it hits or misses, plus whatever the levels below charge
+for the miss (the dirty victim write-back first, then the fill).
+
+Every level takes an Observer told about each access that reaches it, which is
+how the latency and region statistics see the levels below L1; the default
+NoObserver compiles to nothing.
+*/
+
+namespace cachesim {
+
+constexpr bool isPowerOfTwo(uint32_t value) { return value != 0 && (value & (value - 1)) == 0; }
+
+/*********************** Replacement policies *************************/
+
+struct LRU { // Least recently used, tracked with a per-set access counter
+  template <uint32_t Ways> struct Set {
+    uint32_t Clock = 0;
+    uint32_t Time[Ways] = {};
+
+    void touch(uint32_t way) { Time[way] = ++Clock; }
+    void fill(uint32_t way) { Time[way] = ++Clock; }
+    uint32_t victim() const {
+      uint32_t way = 0;
+      for (uint32_t i = 1; i < Ways; i++) {
+        if (Time[i] < Time[way])
+          way = i;
+      }
+      return way;
+    }
+  };
+};
+
+struct FIFO { // Oldest fill is evicted first, hits do not matter
+  template <uint32_t Ways> struct Set {
+    uint32_t Next = 0;
+
+    void touch(uint32_t) {}
+    void fill(uint32_t) { Next = (Next + 1) % Ways; }
+    uint32_t victim() const { return Next; }
+  };
+};
+
+/*********************** Observers *************************/
+
+struct NoObserver { // Access notifications are dropped
+  template <uint32_t Mode> static void note(uint32_t) {}
+};
+
+/*********************** Write policies *************************/
+
+struct WriteBack { // Writes stay in the level until the dirty line is evicted
+  static constexpr bool Through = false;
+};
+
+struct WriteThrough { // Writes are forwarded to the level below, lines are never dirty
+  static constexpr bool Through = true;
+};
+
+/*********************** Main memory *************************/
+
+template <uint32_t Size, uint32_t ReadTime, uint32_t WriteTime, typename Observer = NoObserver>
+class Memory {
+public:
+  static constexpr uint32_t size = Size;
+
+  void reset() {} // Memory keeps its contents across runs, like DRAM in the C hierarchies
+
+  template <uint32_t Mode, uint32_t Bytes>
+  void access(uint32_t address, uint8_t *data, uint32_t &time) {
+    static_assert(Mode == MODE_READ || Mode == MODE_WRITE, "unknown access mode");
+
+    Observer::template note<Mode>(address);
+
+    if (address > Size - Bytes)
+      exit(-1);
+
+    if constexpr (Mode == MODE_READ) {
+      memcpy(data, &Data[address], Bytes);
+      time += ReadTime;
+    } else {
+      memcpy(&Data[address], data, Bytes);
+      time += WriteTime;
+    }
+  }
+
+private:
+  uint8_t Data[Size] = {};
+};
+
+/*********************** Cache level *************************/
+
+template <uint32_t Sets, uint32_t Ways, uint32_t BlockSize, typename Policy, typename WritePolicy, uint32_t ReadTime, uint32_t WriteTime,
+          typename Observer = NoObserver>
+class CacheLevel {
+  static_assert(isPowerOfTwo(Sets), "the number of sets must be a power of two");
+  static_assert(isPowerOfTwo(BlockSize), "the block size must be a power of two");
+  static_assert(Ways > 0, "a cache level needs at least one way");
+
+public:
+  static constexpr uint32_t sets = Sets;
+  static constexpr uint32_t ways = Ways;
+  static constexpr uint32_t blockSize = BlockSize;
+  static constexpr uint32_t size = Sets * Ways * BlockSize;
+
+  static constexpr uint32_t offset(uint32_t address) { return address % BlockSize; }
+  static constexpr uint32_t index(uint32_t address) { return (address / BlockSize) % Sets; }
+  static constexpr uint32_t tag(uint32_t address) { return address / (BlockSize * Sets); }
+  static constexpr uint32_t blockAddress(uint32_t Tag, uint32_t Index) { return (Tag * Sets + Index) * BlockSize; }
+
+  void reset() { // Invalidates every line; dirty data is dropped, as initCache does
+    for (uint32_t i = 0; i < Sets; i++)
+      Lines[i] = Set();
+  }
+
+  template <uint32_t Mode, uint32_t Bytes, typename Below>
+  void access(uint32_t address, uint8_t *data, Below &below, uint32_t &time) {
+    /*
+    Accesses Bytes bytes (a word from the CPU, or a whole block from the level
+    above) at address. Misses write the victim back if it is dirty and fetch the
+    block from the level below before the access is served from the line
+    */
+
+    static_assert(Mode == MODE_READ || Mode == MODE_WRITE, "unknown access mode");
+    static_assert(Bytes <= BlockSize, "an access cannot span several blocks");
+
+    Observer::template note<Mode>(address);
+
+    Set &set = Lines[index(address)];
+    const uint32_t Tag = tag(address);
+    uint32_t way = 0;
+
+    while (way < Ways && !(set.Line[way].Valid && set.Line[way].Tag == Tag))
+      way++;
+
+    if (way == Ways) { // miss
+      way = 0;
+      while (way < Ways && set.Line[way].Valid)
+        way++;
+      if (way == Ways)
+        way = set.Replacement.victim();
+
+      CacheLine &Line = set.Line[way];
+      if (Line.Valid && Line.Dirty)
+        below.template access<MODE_WRITE, BlockSize>(blockAddress(Line.Tag, index(address)), Line.Data, time);
+
+      below.template access<MODE_READ, BlockSize>(address - offset(address), Line.Data, time);
+      Line.Valid = 1;
+      Line.Dirty = 0;
+      Line.Tag = Tag;
+      set.Replacement.fill(way);
+    } else {
+      set.Replacement.touch(way);
+    }
+
+    CacheLine &Line = set.Line[way];
+
+    if constexpr (Mode == MODE_READ) {
+      memcpy(data, &Line.Data[offset(address)], Bytes);
+      time += ReadTime;
+    } else {
+      memcpy(&Line.Data[offset(address)], data, Bytes);
+      time += WriteTime;
+      if constexpr (WritePolicy::Through)
+        below.template access<MODE_WRITE, Bytes>(address, data, time);
+      else
+        Line.Dirty = 1;
+    }
+  }
+
+private:
+  struct CacheLine {
+    uint8_t Valid = 0;
+    uint8_t Dirty = 0;
+    uint32_t Tag = 0;
+    uint8_t Data[BlockSize] = {};
+  };
+
+  struct Set {
+    CacheLine Line[Ways];
+    typename Policy::template Set<Ways> Replacement;
+  };
+
+  Set Lines[Sets];
+};
+
+/*********************** Hierarchy *************************/
+
+template <typename Top, typename... Below>
+class Hierarchy { // The first level faces the CPU, the last one is main memory
+public:
+  void reset() {
+    top.reset();
+    below.reset();
+  }
+
+  template <uint32_t Mode, uint32_t Bytes>
+  void access(uint32_t address, uint8_t *data, uint32_t &time) {
+    top.template access<Mode, Bytes>(address, data, below, time);
+  }
+
+  auto &memory() { return below.memory(); }
+
+private:
+  Top top;
+  Hierarchy<Below...> below;
+};
+
+template <typename Last>
+class Hierarchy<Last> {
+public:
+  void reset() { last.reset(); }
+
+  template <uint32_t Mode, uint32_t Bytes>
+  void access(uint32_t address, uint8_t *data, uint32_t &time) {
+    last.template access<Mode, Bytes>(address, data, time);
+  }
+
+  Last &memory() { return last; }
+
+private:
+  Last last;
+};
+
+} // namespace cachesim
+
+#endif
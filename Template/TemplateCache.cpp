@@ -0,0 +1,131 @@
+#include "CacheLevel.hpp"
+
+#ifdef MRC_SAMPLING
+extern "C" {
+#include "../MRC/Shards.h"
+}
+#endif
+
+#ifdef LATENCY_HISTOGRAM
+extern "C" {
+#include "../Latency/Latency.h"
+}
+#endif
+
+#ifdef REGION_STATS
+extern "C" {
+#include "../Region/Region.h"
+}
+#endif
+
+/*
+C interface of SimpleCache.h on top of the templated hierarchy. The shape is
+picked at compile time with L2_WAYS: 0 for the L1-only hierarchy, 1 for the
+direct mapped L2 and 2 (the default) for the 2-way L2, matching the C variants
+*/
+
+#ifndef L2_WAYS
+#define L2_WAYS 2
+#endif
+
+using namespace cachesim;
+
+struct L2Observer { // Reports the accesses reaching L2 to the statistics built in, as accessL2 does in the C variants
+  template <uint32_t Mode> static void note([[maybe_unused]] uint32_t address) {
+#ifdef LATENCY_HISTOGRAM
+    noteLatency(LATENCY_L2, Mode);
+#endif
+#ifdef REGION_STATS
+    noteRegion(REGION_L2, address, Mode);
+#endif
+  }
+};
+
+struct DRAMObserver {
+  template <uint32_t Mode> static void note([[maybe_unused]] uint32_t address) {
+#ifdef LATENCY_HISTOGRAM
+    noteLatency(LATENCY_DRAM, Mode);
+#endif
+#ifdef REGION_STATS
+    noteRegion(REGION_DRAM, address, Mode);
+#endif
+  }
+};
+
+using L1 = CacheLevel<L1_SIZE / BLOCK_SIZE, 1, BLOCK_SIZE, LRU, WriteBack, L1_READ_TIME, L1_WRITE_TIME>;
+using DRAM = Memory<DRAM_SIZE, DRAM_READ_TIME, DRAM_WRITE_TIME, DRAMObserver>;
+
+#if L2_WAYS == 0
+using MemoryHierarchy = Hierarchy<L1, DRAM>;
+#else
+using L2 = CacheLevel<L2_SIZE / (BLOCK_SIZE * L2_WAYS), L2_WAYS, BLOCK_SIZE, LRU, WriteBack, L2_READ_TIME, L2_WRITE_TIME, L2Observer>;
+using MemoryHierarchy = Hierarchy<L1, L2, DRAM>;
+#endif
+
+static MemoryHierarchy hierarchy;
+static uint32_t clock; // The global time counter
+
+extern "C" {
+
+void resetTime() { clock = 0; }
+
+uint32_t getTime() { return clock; }
+
+void accessDRAM(uint32_t address, uint8_t *data, uint32_t mode) {
+  if (mode == MODE_READ)
+    hierarchy.memory().access<MODE_READ, BLOCK_SIZE>(address, data, clock);
+  else
+    hierarchy.memory().access<MODE_WRITE, BLOCK_SIZE>(address, data, clock);
+}
+
+void initCache() { hierarchy.reset(); }
+
+void accessL1(uint32_t address, uint8_t *data, uint32_t mode) {
+#ifdef MRC_SAMPLING
+  sampleMRC(address);
+#endif
+  if (mode == MODE_READ)
+    hierarchy.access<MODE_READ, WORD_SIZE>(address, data, clock);
+  else
+    hierarchy.access<MODE_WRITE, WORD_SIZE>(address, data, clock);
+}
+
+void read(uint32_t address, uint8_t *data) {
+#ifdef LATENCY_HISTOGRAM
+  startLatency(clock);
+#endif
+#ifdef REGION_STATS
+  startRegion(address, clock);
+#endif
+#ifdef MRC_SAMPLING
+  sampleMRC(address);
+#endif
+  hierarchy.access<MODE_READ, WORD_SIZE>(address, data, clock);
+#ifdef LATENCY_HISTOGRAM
+  recordLatency(address, MODE_READ, clock);
+#endif
+#ifdef REGION_STATS
+  endRegion(MODE_READ, clock);
+#endif
+}
+
+void write(uint32_t address, uint8_t *data) {
+#ifdef LATENCY_HISTOGRAM
+  startLatency(clock);
+#endif
+#ifdef REGION_STATS
+  startRegion(address, clock);
+#endif
+#ifdef MRC_SAMPLING
+  sampleMRC(address);
+#endif
+  hierarchy.access<MODE_WRITE, WORD_SIZE>(address, data, clock);
+#ifdef LATENCY_HISTOGRAM
+  recordLatency(address, MODE_WRITE, clock);
+#endif
+#ifdef REGION_STATS
+  endRegion(MODE_WRITE, clock);
+#endif
+}
+
+}
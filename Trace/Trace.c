@@ -0,0 +1,465 @@
+#include "Trace.h"
+
+#ifdef TRACE_ZSTD
+#include <zstd.h>
+#endif
+
+#ifdef TRACE_LZ4
+#include <lz4.h>
+#endif
+
+/*********************** Encoding *************************/
+
+static void put32(uint8_t *buffer, uint32_t value) {
+  for (int i = 0; i < 4; i++)
+    buffer[i] = (value >> (8 * i)) & 0xFF;
+}
+
+static uint32_t get32(const uint8_t *buffer) {
+  return buffer[0] | (buffer[1] << 8) | (buffer[2] << 16) | ((uint32_t)buffer[3] << 24);
+}
+
+static uint32_t encodeBlock(const TraceRecord *records, uint32_t count, uint8_t *encoded) {
+  uint32_t previous[2] = {0, 0}; // last address of the write and read streams
+  uint32_t size = 0;
+
+  for (uint32_t i = 0; i < count; i++) {
+    uint32_t op = records[i].op;
+    int64_t delta = 0;
+
+    if (op != TRACE_OP_RESET) {
+      delta = (int64_t)records[i].address - previous[op];
+      previous[op] = records[i].address;
+    }
+
+    uint64_t token = ((((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63)) << 2) | op; // zigzag keeps small negative deltas short
+    do {
+      encoded[size++] = (token & 0x7F) | (token > 0x7F ? 0x80 : 0);
+      token >>= 7;
+    } while (token);
+  }
+
+  return size;
+}
+
+int decodeTraceBlock(const uint8_t *encoded, uint32_t size, uint32_t count, TraceRecord *records) {
+  uint32_t previous[2] = {0, 0};
+  uint32_t position = 0;
+
+  for (uint32_t i = 0; i < count; i++) {
+    uint64_t token = 0;
+    uint32_t shift = 0;
+
+    do {
+      if (position >= size || shift >= 7 * TRACE_MAX_VARINT)
+        return -1;
+      token |= (uint64_t)(encoded[position] & 0x7F) << shift;
+      shift += 7;
+    } while (encoded[position++] & 0x80);
+
+    uint32_t op = token & 0x3;
+    uint64_t zigzag = token >> 2;
+    int64_t delta = (int64_t)(zigzag >> 1) ^ -(int64_t)(zigzag & 1);
+
+    records[i].op = op;
+    if (op == TRACE_OP_RESET) {
+      records[i].address = 0;
+    } else if (op == TRACE_OP_WRITE || op == TRACE_OP_READ) {
+      previous[op] += (uint32_t)delta;
+      records[i].address = previous[op];
+    } else {
+      return -1;
+    }
+  }
+
+  return position == size ? 0 : -1;
+}
+
+/*********************** Compression *************************/
+
+static uint32_t storedBound(uint32_t codec, uint32_t size) { // Worst case output of the codec for size input bytes
+#ifdef TRACE_ZSTD
+  if (codec == TRACE_CODEC_ZSTD)
+    return ZSTD_compressBound(size);
+#endif
+#ifdef TRACE_LZ4
+  if (codec == TRACE_CODEC_LZ4)
+    return LZ4_compressBound(size);
+#endif
+  (void)codec;
+  return size;
+}
+
+static uint32_t compressBlock(uint32_t codec, const uint8_t *encoded, uint32_t size, uint8_t *stored, uint32_t capacity) {
+  /* Returns the compressed size, or 0 when the block is better stored as is */
+
+  size_t compressed = 0;
+
+#ifdef TRACE_ZSTD
+  if (codec == TRACE_CODEC_ZSTD) {
+    compressed = ZSTD_compress(stored, capacity, encoded, size, 3);
+    if (ZSTD_isError(compressed))
+      compressed = 0;
+  }
+#endif
+#ifdef TRACE_LZ4
+  if (codec == TRACE_CODEC_LZ4)
+    compressed = LZ4_compress_default((const char *)encoded, (char *)stored, size, capacity);
+#endif
+  (void)codec, (void)encoded, (void)stored, (void)capacity;
+
+  return compressed < size ? compressed : 0;
+}
+
+static int decompressBlock(uint32_t codec, const uint8_t *stored, uint32_t storedSize, uint8_t *encoded, uint32_t size) {
+  if (codec == TRACE_CODEC_NONE) {
+    if (storedSize != size)
+      return -1;
+    memcpy(encoded, stored, size);
+    return 0;
+  }
+#ifdef TRACE_ZSTD
+  if (codec == TRACE_CODEC_ZSTD)
+    return ZSTD_decompress(encoded, size, stored, storedSize) == size ? 0 : -1;
+#endif
+#ifdef TRACE_LZ4
+  if (codec == TRACE_CODEC_LZ4)
+    return LZ4_decompress_safe((const char *)stored, (char *)encoded, storedSize, size) == (int)size ? 0 : -1;
+#endif
+  return -1; // codec not compiled in
+}
+
+/*********************** Writer *************************/
+
+TraceWriter *openTraceWriter(const char *path, uint32_t codec) {
+  uint8_t header[TRACE_FILE_HEADER_SIZE] = {0};
+  TraceWriter *writer;
+
+#ifndef TRACE_ZSTD
+  if (codec == TRACE_CODEC_ZSTD)
+    return NULL;
+#endif
+#ifndef TRACE_LZ4
+  if (codec == TRACE_CODEC_LZ4)
+    return NULL;
+#endif
+  if (codec > TRACE_CODEC_LZ4)
+    return NULL;
+
+  writer = calloc(1, sizeof(TraceWriter));
+  if (writer == NULL)
+    return NULL;
+
+  writer->codec = codec;
+  writer->stored = malloc(storedBound(codec, sizeof(writer->encoded)));
+  writer->file = fopen(path, "wb");
+  if (writer->stored == NULL || writer->file == NULL) {
+    if (writer->file != NULL)
+      fclose(writer->file);
+    free(writer->stored);
+    free(writer);
+    return NULL;
+  }
+
+  memcpy(header, TRACE_MAGIC, 4);
+  header[4] = TRACE_VERSION;
+  if (fwrite(header, 1, TRACE_FILE_HEADER_SIZE, writer->file) != TRACE_FILE_HEADER_SIZE) {
+    fclose(writer->file);
+    free(writer->stored);
+    free(writer);
+    return NULL;
+  }
+  writer->totalStored = TRACE_FILE_HEADER_SIZE;
+
+  return writer;
+}
+
+int flushTraceWriter(TraceWriter *writer) {
+  uint8_t header[TRACE_BLOCK_HEADER_SIZE] = {0};
+  uint32_t size, storedSize, codec = writer->codec;
+  const uint8_t *payload = writer->stored;
+
+  if (writer->count == 0)
+    return 0;
+
+  size = encodeBlock(writer->records, writer->count, writer->encoded);
+  storedSize = codec == TRACE_CODEC_NONE ? 0 : compressBlock(codec, writer->encoded, size, writer->stored, storedBound(codec, sizeof(writer->encoded)));
+  if (storedSize == 0) { // Incompressible (or uncompressed) blocks are stored as encoded
+    codec = TRACE_CODEC_NONE;
+    storedSize = size;
+    payload = writer->encoded;
+  }
+
+  put32(&header[0], writer->count);
+  put32(&header[4], size);
+  put32(&header[8], storedSize);
+  header[12] = codec;
+
+  if (fwrite(header, 1, TRACE_BLOCK_HEADER_SIZE, writer->file) != TRACE_BLOCK_HEADER_SIZE ||
+      fwrite(payload, 1, storedSize, writer->file) != storedSize)
+    return -1;
+
+  writer->totalRecords += writer->count;
+  writer->totalEncoded += size;
+  writer->totalStored += TRACE_BLOCK_HEADER_SIZE + storedSize;
+  writer->count = 0;
+  return 0;
+}
+
+int traceRecord(TraceWriter *writer, uint32_t op, uint32_t address) {
+  if (op > TRACE_OP_RESET)
+    return -1;
+
+  writer->records[writer->count].op = op;
+  writer->records[writer->count].address = address;
+  writer->count++;
+
+  if (writer->count == TRACE_BLOCK_RECORDS)
+    return flushTraceWriter(writer);
+  return 0;
+}
+
+int closeTraceWriter(TraceWriter *writer) {
+  int status = flushTraceWriter(writer);
+
+  if (fclose(writer->file) != 0)
+    status = -1;
+  free(writer->stored);
+  free(writer);
+  return status;
+}
+
+/*********************** Reader *************************/
+
+static int readBlock(FILE *file, long offset, uint8_t **stored, uint32_t *storedCapacity, uint8_t *encoded, TraceSlot *slot) {
+  /* Reads, decompresses and decodes one block into a slot */
+
+  uint8_t header[TRACE_BLOCK_HEADER_SIZE];
+  uint32_t count, size, storedSize, codec;
+
+  if (fseek(file, offset, SEEK_SET) != 0 || fread(header, 1, TRACE_BLOCK_HEADER_SIZE, file) != TRACE_BLOCK_HEADER_SIZE)
+    return -1;
+
+  count = get32(&header[0]);
+  size = get32(&header[4]);
+  storedSize = get32(&header[8]);
+  codec = header[12];
+
+  if (count == 0 || count > TRACE_BLOCK_RECORDS || size > TRACE_BLOCK_RECORDS * TRACE_MAX_VARINT)
+    return -1;
+
+  if (storedSize > *storedCapacity) {
+    uint8_t *grown = realloc(*stored, storedSize);
+    if (grown == NULL)
+      return -1;
+    *stored = grown;
+    *storedCapacity = storedSize;
+  }
+
+  if (fread(*stored, 1, storedSize, file) != storedSize || decompressBlock(codec, *stored, storedSize, encoded, size) != 0)
+    return -1;
+
+  slot->count = count;
+  return decodeTraceBlock(encoded, size, count, slot->records);
+}
+
+static void *decodeWorker(void *argument) {
+  /*
+  Decoder thread. Claims blocks in trace order, each one into slot block % TRACE_SLOTS,
+  waiting while that slot still holds a block the simulator has not consumed yet.
+  Every thread has its own file handle, so reads and decoding both run in parallel
+  */
+
+  TraceReader *reader = argument;
+  uint8_t *encoded = malloc(TRACE_BLOCK_RECORDS * TRACE_MAX_VARINT);
+  uint8_t *stored = NULL;
+  uint32_t storedCapacity = 0;
+  FILE *file = fopen(reader->path, "rb");
+
+  pthread_mutex_lock(&reader->lock);
+  if (encoded == NULL || file == NULL) {
+    reader->error = 1;
+    pthread_cond_broadcast(&reader->ready);
+  }
+
+  while (!reader->error && !reader->stop && !reader->corrupt && reader->nextBlock < reader->blocks) {
+    uint32_t block = reader->nextBlock;
+    TraceSlot *slot = &reader->slots[block % TRACE_SLOTS];
+
+    if (slot->state != TRACE_SLOT_FREE) {
+      pthread_cond_wait(&reader->freed, &reader->lock);
+      continue;
+    }
+
+    reader->nextBlock++;
+    slot->block = block;
+    slot->state = TRACE_SLOT_DECODING;
+    pthread_mutex_unlock(&reader->lock);
+
+    int status = readBlock(file, reader->offsets[block], &stored, &storedCapacity, encoded, slot);
+
+    pthread_mutex_lock(&reader->lock);
+    if (status != 0) // reported when the simulator reaches the block, the blocks before it are still replayed
+      reader->corrupt = 1;
+    slot->state = status == 0 ? TRACE_SLOT_READY : TRACE_SLOT_CORRUPT;
+    pthread_cond_broadcast(&reader->ready);
+  }
+
+  pthread_mutex_unlock(&reader->lock);
+
+  if (file != NULL)
+    fclose(file);
+  free(stored);
+  free(encoded);
+  return NULL;
+}
+
+static int indexBlocks(TraceReader *reader) {
+  /*
+  Walks the block headers once so the decoder threads can seek straight to their blocks.
+  The blocks have to end exactly at the end of the file: a trace cut inside a block
+  header or payload is corrupt, not a shorter trace
+  */
+
+  uint8_t header[TRACE_BLOCK_HEADER_SIZE];
+  uint32_t capacity = 0;
+  long offset = TRACE_FILE_HEADER_SIZE, end;
+  FILE *file = fopen(reader->path, "rb");
+
+  if (file == NULL)
+    return -1;
+
+  if (fseek(file, 0, SEEK_END) != 0 || (end = ftell(file)) < 0 || fseek(file, 0, SEEK_SET) != 0 ||
+      fread(header, 1, TRACE_FILE_HEADER_SIZE, file) != TRACE_FILE_HEADER_SIZE ||
+      memcmp(header, TRACE_MAGIC, 4) != 0 || header[4] != TRACE_VERSION) {
+    fclose(file);
+    return -1;
+  }
+
+  while (offset < end) {
+    if (end - offset < TRACE_BLOCK_HEADER_SIZE || fread(header, 1, TRACE_BLOCK_HEADER_SIZE, file) != TRACE_BLOCK_HEADER_SIZE) {
+      fclose(file);
+      return -1;
+    }
+
+    if (reader->blocks == capacity) {
+      capacity = capacity ? 2 * capacity : 64;
+      long *grown = realloc(reader->offsets, capacity * sizeof(long));
+      if (grown == NULL) {
+        fclose(file);
+        return -1;
+      }
+      reader->offsets = grown;
+    }
+    reader->offsets[reader->blocks++] = offset;
+
+    offset += TRACE_BLOCK_HEADER_SIZE + get32(&header[8]);
+    if (offset > end || fseek(file, offset, SEEK_SET) != 0) {
+      fclose(file);
+      return -1;
+    }
+  }
+
+  fclose(file);
+  return 0;
+}
+
+TraceReader *openTraceReader(const char *path, uint32_t threads) {
+  TraceReader *reader;
+
+  if (threads < 1)
+    threads = 1;
+  if (threads > TRACE_MAX_THREADS)
+    threads = TRACE_MAX_THREADS;
+
+  reader = calloc(1, sizeof(TraceReader));
+  if (reader == NULL)
+    return NULL;
+
+  reader->path = malloc(strlen(path) + 1);
+  if (reader->path == NULL) {
+    free(reader);
+    return NULL;
+  }
+  strcpy(reader->path, path);
+
+  if (indexBlocks(reader) != 0) {
+    free(reader->offsets);
+    free(reader->path);
+    free(reader);
+    return NULL;
+  }
+
+  for (int i = 0; i < TRACE_SLOTS; i++) {
+    reader->slots[i].block = -1;
+    reader->slots[i].state = TRACE_SLOT_FREE;
+  }
+
+  pthread_mutex_init(&reader->lock, NULL);
+  pthread_cond_init(&reader->ready, NULL);
+  pthread_cond_init(&reader->freed, NULL);
+
+  for (reader->threads = 0; reader->threads < threads; reader->threads++) {
+    if (pthread_create(&reader->workers[reader->threads], NULL, decodeWorker, reader) != 0)
+      break;
+  }
+
+  if (reader->threads == 0) {
+    closeTraceReader(reader);
+    return NULL;
+  }
+
+  return reader;
+}
+
+int nextTraceRecord(TraceReader *reader, TraceRecord *record) {
+  if (reader->slot == NULL) { // Waits for the current block to be decoded
+    if (reader->current >= reader->blocks)
+      return 0;
+
+    TraceSlot *slot = &reader->slots[reader->current % TRACE_SLOTS];
+
+    pthread_mutex_lock(&reader->lock);
+    while (!reader->error && (slot->block != reader->current || slot->state < TRACE_SLOT_READY)) // claimed in order, so
+      pthread_cond_wait(&reader->ready, &reader->lock); // no block before a corrupt one is left unclaimed
+    uint32_t error = reader->error || slot->state == TRACE_SLOT_CORRUPT;
+    pthread_mutex_unlock(&reader->lock);
+
+    if (error)
+      return -1;
+
+    reader->slot = slot;
+    reader->position = 0;
+  }
+
+  *record = reader->slot->records[reader->position++];
+
+  if (reader->position == reader->slot->count) { // Hands the slot back to the decoder threads
+    pthread_mutex_lock(&reader->lock);
+    reader->slot->state = TRACE_SLOT_FREE;
+    pthread_cond_broadcast(&reader->freed);
+    pthread_mutex_unlock(&reader->lock);
+
+    reader->slot = NULL;
+    reader->current++;
+  }
+
+  return 1;
+}
+
+void closeTraceReader(TraceReader *reader) {
+  pthread_mutex_lock(&reader->lock);
+  reader->stop = 1;
+  pthread_cond_broadcast(&reader->freed);
+  pthread_mutex_unlock(&reader->lock);
+
+  for (uint32_t i = 0; i < reader->threads; i++)
+    pthread_join(reader->workers[i], NULL);
+
+  pthread_mutex_destroy(&reader->lock);
+  pthread_cond_destroy(&reader->ready);
+  pthread_cond_destroy(&reader->freed);
+  free(reader->offsets);
+  free(reader->path);
+  free(reader);
+}
@@ -0,0 +1,105 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "../Cache.h"
+
+/*
+Compressed trace format. A trace is a sequence of (op, address) records split
+into blocks of at most TRACE_BLOCK_RECORDS records:
+
+  file  : "CSTR" | version (1 byte) | 3 reserved bytes | block*
+  block : records (4) | encoded size (4) | stored size (4) | codec (1) | 3 reserved bytes | payload
+
+Every record becomes one varint holding (zigzag(address - previous) << 2) | op,
+where previous is the last address of the same op (reads and writes are separate
+streams, so a sweep costs one byte per access). The predictors restart at every
+block, so blocks decode independently of each other. The encoded bytes are then
+optionally compressed with zstd or LZ4. All integers are little endian
+*/
+
+#define TRACE_MAGIC "CSTR"
+#define TRACE_VERSION 1
+#define TRACE_FILE_HEADER_SIZE 8 // in bytes
+#define TRACE_BLOCK_HEADER_SIZE 16 // in bytes
+#define TRACE_BLOCK_RECORDS (64 * 1024) // Records per block
+#define TRACE_MAX_VARINT 5 // in bytes // Longest encoding of one record
+#define TRACE_SLOTS 16 // Decoded blocks buffered ahead of the simulator
+#define TRACE_MAX_THREADS TRACE_SLOTS // Decoder threads beyond the number of slots would only wait
+
+#define TRACE_OP_WRITE MODE_WRITE
+#define TRACE_OP_READ MODE_READ
+#define TRACE_OP_RESET 2 // resetTime() + initCache(), i.e. the start of a new run
+
+#define TRACE_CODEC_NONE 0
+#define TRACE_CODEC_ZSTD 1 // needs -DTRACE_ZSTD and -lzstd
+#define TRACE_CODEC_LZ4 2 // needs -DTRACE_LZ4 and -llz4
+
+typedef struct TraceRecord {
+  uint32_t op;
+  uint32_t address;
+} TraceRecord;
+
+/*********************** Writer *************************/
+
+typedef struct TraceWriter {
+  FILE *file;
+  uint32_t codec;
+  uint32_t count; // records buffered for the current block
+  TraceRecord records[TRACE_BLOCK_RECORDS];
+  uint8_t encoded[TRACE_BLOCK_RECORDS * TRACE_MAX_VARINT];
+  uint8_t *stored; // compression output, sized for the codec's worst case
+  uint64_t totalRecords;
+  uint64_t totalEncoded; // bytes before compression
+  uint64_t totalStored; // bytes written, headers included
+} TraceWriter;
+
+TraceWriter *openTraceWriter(const char *, uint32_t); // Creates a trace file using the given codec, NULL on failure
+int traceRecord(TraceWriter *, uint32_t, uint32_t); // Appends an (op, address) record, -1 on failure
+int flushTraceWriter(TraceWriter *); // Ends the current block early, -1 on failure
+int closeTraceWriter(TraceWriter *); // Flushes the last block and frees the writer, -1 on failure
+
+/*********************** Reader *************************/
+
+typedef struct TraceSlot {
+  int64_t block; // block held by the slot, -1 if none
+  uint32_t state; // TRACE_SLOT_FREE, TRACE_SLOT_DECODING, TRACE_SLOT_READY or TRACE_SLOT_CORRUPT
+  uint32_t count;
+  TraceRecord records[TRACE_BLOCK_RECORDS];
+} TraceSlot;
+
+#define TRACE_SLOT_FREE 0
+#define TRACE_SLOT_DECODING 1
+#define TRACE_SLOT_READY 2
+#define TRACE_SLOT_CORRUPT 3 // the block could not be read or decoded
+
+typedef struct TraceReader {
+  char *path;
+  uint32_t blocks;
+  long *offsets; // file offset of every block header
+  uint32_t threads;
+  pthread_t workers[TRACE_MAX_THREADS];
+  pthread_mutex_t lock;
+  pthread_cond_t ready; // a slot finished decoding
+  pthread_cond_t freed; // the simulator released a slot
+  uint32_t nextBlock; // next block to be claimed by a decoder thread
+  uint32_t stop;
+  uint32_t error; // a decoder thread could not start
+  uint32_t corrupt; // a block is corrupt, no block after it is claimed
+  uint32_t current; // block being consumed by the simulator
+  uint32_t position; // next record within the current block
+  TraceSlot *slot; // slot of the current block once it is ready
+  TraceSlot slots[TRACE_SLOTS];
+} TraceReader;
+
+TraceReader *openTraceReader(const char *, uint32_t); // Indexes the blocks and starts the decoder threads, NULL on failure or a truncated trace
+int nextTraceRecord(TraceReader *, TraceRecord *); // 1 with the next record in trace order, 0 at the end, -1 on a corrupt trace
+void closeTraceReader(TraceReader *); // Stops the decoder threads and frees the reader
+
+int decodeTraceBlock(const uint8_t *, uint32_t, uint32_t, TraceRecord *); // Decodes the encoded bytes of one block, -1 if malformed
+
+#endif
@@ -0,0 +1,68 @@
+#include "Trace.h"
+
+int main(int argc, char **argv) {
+  /*
+  Converts the text output of SimpleProgram (the format of tests/results_*.txt)
+  into a compressed trace. Every "Number of words" line starts a new run, which
+  is recorded as a TRACE_OP_RESET
+
+  usage: TraceConvert [-z | -l] <results.txt> <output.trace>
+  */
+
+  uint32_t codec = TRACE_CODEC_NONE;
+  char line[256];
+  uint32_t address;
+  int arg = 1;
+
+  if (argc > arg && strcmp(argv[arg], "-z") == 0) {
+    codec = TRACE_CODEC_ZSTD;
+    arg++;
+  } else if (argc > arg && strcmp(argv[arg], "-l") == 0) {
+    codec = TRACE_CODEC_LZ4;
+    arg++;
+  }
+
+  if (argc != arg + 2) {
+    fprintf(stderr, "usage: %s [-z | -l] <results.txt> <output.trace>\n", argv[0]);
+    return -1;
+  }
+
+  FILE *input = fopen(argv[arg], "r");
+  if (input == NULL) {
+    fprintf(stderr, "cannot open %s\n", argv[arg]);
+    return -1;
+  }
+
+  TraceWriter *writer = openTraceWriter(argv[arg + 1], codec);
+  if (writer == NULL) {
+    fprintf(stderr, "cannot create %s (is the codec compiled in?)\n", argv[arg + 1]);
+    fclose(input);
+    return -1;
+  }
+
+  int status = 0;
+  while (status == 0 && fgets(line, sizeof(line), input) != NULL) {
+    if (strncmp(line, "Number of words", 15) == 0)
+      status = traceRecord(writer, TRACE_OP_RESET, 0);
+    else if (sscanf(line, "Write; Address %u;", &address) == 1)
+      status = traceRecord(writer, TRACE_OP_WRITE, address);
+    else if (sscanf(line, "Read; Address %u;", &address) == 1)
+      status = traceRecord(writer, TRACE_OP_READ, address);
+  }
+  fclose(input);
+
+  if (status == 0)
+    status = flushTraceWriter(writer);
+
+  uint64_t records = writer->totalRecords;
+  uint64_t encoded = writer->totalEncoded;
+  uint64_t stored = writer->totalStored;
+
+  if (closeTraceWriter(writer) != 0 || status != 0) {
+    fprintf(stderr, "cannot write %s\n", argv[arg + 1]);
+    return -1;
+  }
+
+  printf("Records %llu; Encoded bytes %llu; File bytes %llu\n", (unsigned long long)records, (unsigned long long)encoded, (unsigned long long)stored);
+  return 0;
+}
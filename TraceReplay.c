@@ -0,0 +1,118 @@
+#include "SimpleCache.h"
+#include "Trace/Trace.h"
+
+int main(int argc, char **argv) {
+  /*
+  Replays a compressed trace through the cache hierarchy it is linked with.
+  Blocks are decoded by <threads> decoder threads ahead of the simulator; like
+  SimpleProgram, every write stores its own address as the value. Built with
+  REGION_STATS, -r loads a region file for per-region attribution and -s keeps
+  only the accesses to the listed regions, the others are not simulated
+
+  usage: TraceReplay [-q] [-r regions] [-s label,...] <trace> [threads]
+  */
+
+  TraceRecord record;
+  uint32_t value, threads = 1;
+  uint64_t accesses = 0, filtered = 0;
+  int quiet = 0, arg = 1, status;
+  const char *regionFile = NULL, *selected = NULL;
+
+  while (argc > arg && argv[arg][0] == '-') {
+    if (strcmp(argv[arg], "-q") == 0)
+      quiet = 1;
+    else if (strcmp(argv[arg], "-r") == 0 && argc > arg + 1)
+      regionFile = argv[++arg];
+    else if (strcmp(argv[arg], "-s") == 0 && argc > arg + 1)
+      selected = argv[++arg];
+    else
+      break;
+    arg++;
+  }
+
+  if (argc != arg + 1 && argc != arg + 2) {
+    fprintf(stderr, "usage: %s [-q] [-r regions] [-s label,...] <trace> [threads]\n", argv[0]);
+    return -1;
+  }
+  if (argc == arg + 2)
+    threads = atoi(argv[arg + 1]);
+
+#ifdef REGION_STATS
+  if (regionFile != NULL && loadRegions(regionFile) != 0)
+    return -1;
+  if (selected != NULL && selectRegions(selected) != 0) {
+    fprintf(stderr, "unknown region in %s\n", selected);
+    return -1;
+  }
+#else
+  if (regionFile != NULL || selected != NULL) {
+    fprintf(stderr, "-r and -s need a build with REGIONS=1\n");
+    return -1;
+  }
+#endif
+
+  TraceReader *reader = openTraceReader(argv[arg], threads);
+  if (reader == NULL) {
+    fprintf(stderr, "cannot open trace %s (missing, truncated or not a trace)\n", argv[arg]);
+    return -1;
+  }
+
+  resetTime();
+  initCache();
+
+  while ((status = nextTraceRecord(reader, &record)) == 1) {
+#ifdef REGION_STATS
+    if (record.op != TRACE_OP_RESET && !regionSelected(record.address)) {
+      filtered++;
+      continue;
+    }
+#endif
+    switch (record.op) {
+      case TRACE_OP_RESET:
+        resetTime();
+        initCache();
+        break;
+      case TRACE_OP_READ:
+        read(record.address, (uint8_t *)(&value));
+        accesses++;
+        if (!quiet)
+          printf("Read; Address %u; Value %u; Time %u\n", record.address, value, getTime());
+        break;
+      case TRACE_OP_WRITE:
+        write(record.address, (uint8_t *)(&record.address));
+        accesses++;
+        if (!quiet)
+          printf("Write; Address %u; Value %u; Time %u\n", record.address, record.address, getTime());
+        break;
+    }
+  }
+
+  closeTraceReader(reader);
+
+  if (status != 0) {
+    fprintf(stderr, "corrupt trace %s\n", argv[arg]);
+    return -1;
+  }
+
+  printf("\nAccesses %llu; Time %u\n", (unsigned long long)accesses, getTime());
+  if (filtered != 0)
+    printf("Filtered out %llu accesses\n", (unsigned long long)filtered);
+
+#ifdef VIRTUAL_MEMORY
+  printTLBStats();
+#endif
+
+#ifdef MRC_SAMPLING
+  printMRC();
+#endif
+
+#ifdef LATENCY_HISTOGRAM
+  printLatencyReport();
+#endif
+
+#ifdef REGION_STATS
+  printRegionReport();
+#endif
+
+  return 0;
+}
@@ -0,0 +1,246 @@
+#include "TLB.h"
+
+extern uint8_t DRAM[DRAM_SIZE]; // The page tables live in the simulated main memory
+extern uint32_t time; // The global time counter of the cache hierarchy
+TLB tlb;
+
+static const uint32_t levelShift[PT_LEVELS] = {30, 21, 12}; // Lowest virtual address bit translated by each level
+static const uint32_t levelEntries[PT_LEVELS] = {4, 512, 512}; // Number of entries in a table of each level
+
+static uint32_t entryAddress(uint32_t table, uint32_t address, uint32_t level) {
+  return table + ((address >> levelShift[level]) % levelEntries[level]) * PTE_SIZE;
+}
+
+/*********************** Page tables *************************/
+
+static void buildPageTables() {
+  /*
+  Identity maps the DRAM below the page tables with pages of PAGE_SIZE. The tables
+  are written straight into DRAM (as the operating system would before running the
+  program), so the walker later finds them through the cache hierarchy like any
+  other data. Their own frames are left unmapped (with huge pages the page holding
+  them is mapped, translateAddress faults above VM_MAPPED_SIZE instead)
+  */
+
+  uint32_t nextTable = PT_BASE + PT_TABLE_SIZE; // The root table takes the first frame of the region
+  uint32_t leaf = PT_LEAF_LEVEL;
+  uint32_t entry;
+
+  memset(&(DRAM[PT_BASE]), 0, PT_REGION_SIZE);
+
+  for (uint32_t page = 0; page < VM_MAPPED_SIZE; page += PAGE_SIZE) {
+    uint32_t table = PT_BASE;
+
+    for (uint32_t level = 0; level < leaf; level++) { // Allocates the intermediate tables on the way down
+      memcpy(&entry, &(DRAM[entryAddress(table, page, level)]), PTE_SIZE);
+      if (!(entry & PTE_PRESENT)) {
+        if (nextTable + PT_TABLE_SIZE > DRAM_SIZE)
+          exit(-1);
+        entry = nextTable | PTE_PRESENT;
+        nextTable += PT_TABLE_SIZE;
+        memcpy(&(DRAM[entryAddress(table, page, level)]), &entry, PTE_SIZE);
+      }
+      table = entry & PTE_FRAME_MASK;
+    }
+
+    entry = page | PTE_PRESENT;
+    if (leaf != PT_LEVELS - 1)
+      entry |= PTE_HUGE;
+    memcpy(&(DRAM[entryAddress(table, page, leaf)]), &entry, PTE_SIZE);
+  }
+}
+
+/*********************** Page-walk cache *************************/
+
+static PWCEntry *lookupPWC(uint32_t address, uint32_t level) {
+  for (int i = 0; i < PWC_ENTRIES; i++) {
+    PWCEntry *Entry = &tlb.PWC.Entries[i];
+    if (Entry->Valid && Entry->Level == level && Entry->Tag == (address >> levelShift[level])) {
+      Entry->Time = ++tlb.clock;
+      return Entry;
+    }
+  }
+  return NULL;
+}
+
+static void fillPWC(uint32_t address, uint32_t level, uint32_t entry) {
+  int victim = 0;
+  for (int i = 0; i < PWC_ENTRIES; i++) { // First invalid entry, otherwise the least recently used one
+    if (!tlb.PWC.Entries[i].Valid) {
+      victim = i;
+      break;
+    }
+    if (tlb.PWC.Entries[i].Time < tlb.PWC.Entries[victim].Time)
+      victim = i;
+  }
+
+  tlb.PWC.Entries[victim].Valid = 1;
+  tlb.PWC.Entries[victim].Level = level;
+  tlb.PWC.Entries[victim].Tag = address >> levelShift[level];
+  tlb.PWC.Entries[victim].Entry = entry;
+  tlb.PWC.Entries[victim].Time = ++tlb.clock;
+}
+
+/*********************** Page walker *************************/
+
+static uint32_t walkPageTable(uint32_t address) {
+  /*
+  Walks the page tables for a virtual address and returns the physical page number.
+  The deepest upper level entry found in the page-walk cache lets the walker skip
+  the levels above it; every other entry is read through accessPageTable, so its
+  cost depends on whether it hits in the caches or has to go to DRAM
+  */
+
+  uint32_t table = PT_BASE; // Root table address (the CR3 register on x86)
+  uint32_t level = 0;
+  uint32_t entry;
+
+  tlb.stats.Walks++;
+
+  for (int cached = PT_LEAF_LEVEL - 1; cached >= 0; cached--) {
+    PWCEntry *Entry = lookupPWC(address, cached);
+    if (Entry != NULL) {
+      table = Entry->Entry & PTE_FRAME_MASK;
+      level = cached + 1;
+      break;
+    }
+  }
+
+  if (level > 0)
+    tlb.stats.PWCHits++;
+  else if (PT_LEAF_LEVEL > 0)
+    tlb.stats.PWCMisses++;
+
+  while (1) {
+    accessPageTable(entryAddress(table, address, level), (uint8_t *)&entry);
+    tlb.stats.WalkAccesses++;
+
+    if (!(entry & PTE_PRESENT)) // Page fault: nothing is mapped outside DRAM or over the page tables
+      exit(-1);
+
+    if ((entry & PTE_HUGE) || level == PT_LEVELS - 1)
+      return (entry & PTE_FRAME_MASK) >> levelShift[level];
+
+    fillPWC(address, level, entry);
+    table = entry & PTE_FRAME_MASK;
+    level++;
+  }
+}
+
+/*********************** TLB *************************/
+
+static TLBEntry *lookupSet(TLBEntry *Set, uint32_t ways, uint32_t Tag) {
+  for (uint32_t i = 0; i < ways; i++) {
+    if (Set[i].Valid && Set[i].Tag == Tag) {
+      Set[i].Time = ++tlb.clock;
+      return &Set[i];
+    }
+  }
+  return NULL;
+}
+
+static void fillSet(TLBEntry *Set, uint32_t ways, uint32_t Tag, uint32_t Frame) {
+  uint32_t victim = 0;
+  for (uint32_t i = 0; i < ways; i++) { // First invalid way, otherwise the least recently used one
+    if (!Set[i].Valid) {
+      victim = i;
+      break;
+    }
+    if (Set[i].Time < Set[victim].Time)
+      victim = i;
+  }
+
+  Set[victim].Valid = 1;
+  Set[victim].Tag = Tag;
+  Set[victim].Frame = Frame;
+  Set[victim].Time = ++tlb.clock;
+}
+
+void initTLB() { // Flushes both TLB levels and the page-walk cache; the counters keep accumulating
+  if (!tlb.tablesBuilt) {
+    buildPageTables();
+    tlb.tablesBuilt = 1;
+  }
+
+  memset(&tlb.L1, 0, sizeof(tlb.L1));
+  memset(&tlb.L2, 0, sizeof(tlb.L2));
+  memset(&tlb.PWC, 0, sizeof(tlb.PWC));
+  tlb.clock = 0;
+  tlb.init = 1;
+}
+
+static uint32_t lookupTranslation(uint32_t address) {
+  /*
+  Looks the virtual page up in the L1 TLB, then in the L2 TLB, and finally walks
+  the page tables. Translations found further down are filled into the levels above
+
+  address : The virtual byte address of the memory location being accessed
+  */
+
+  uint32_t page, offset, Frame;
+  TLBEntry *Entry;
+
+  if (!tlb.init)
+    initTLB();
+
+  if (address >= VM_MAPPED_SIZE) // Page fault, even when a huge page covers the page tables
+    exit(-1);
+
+  page = address >> PAGE_SHIFT;
+  offset = address % PAGE_SIZE;
+
+  TLBEntry *L1Set = tlb.L1.Entries[page % TLB_L1_SETS];
+  TLBEntry *L2Set = tlb.L2.Entries[page % TLB_L2_SETS];
+
+  time += TLB_L1_TIME;
+  Entry = lookupSet(L1Set, TLB_L1_ASSOCIATIVITY, page / TLB_L1_SETS);
+  if (Entry != NULL) {
+    tlb.stats.L1Hits++;
+    return (Entry->Frame << PAGE_SHIFT) | offset;
+  }
+  tlb.stats.L1Misses++;
+
+  time += TLB_L2_TIME;
+  Entry = lookupSet(L2Set, TLB_L2_ASSOCIATIVITY, page / TLB_L2_SETS);
+  if (Entry != NULL) {
+    tlb.stats.L2Hits++;
+    Frame = Entry->Frame;
+  } else {
+    tlb.stats.L2Misses++;
+    Frame = walkPageTable(address);
+    fillSet(L2Set, TLB_L2_ASSOCIATIVITY, page / TLB_L2_SETS, Frame);
+  }
+
+  fillSet(L1Set, TLB_L1_ASSOCIATIVITY, page / TLB_L1_SETS, Frame);
+  return (Frame << PAGE_SHIFT) | offset;
+}
+
+uint32_t translateAddress(uint32_t address) { // Brackets the translation for the access statistics, whose page table reads are not data accesses
+#ifdef LATENCY_HISTOGRAM
+  startTranslationLatency(time);
+#endif
+#ifdef REGION_STATS
+  startTranslationRegion(time);
+#endif
+
+  address = lookupTranslation(address);
+
+#ifdef LATENCY_HISTOGRAM
+  endTranslationLatency(time);
+#endif
+#ifdef REGION_STATS
+  endTranslationRegion(time);
+#endif
+
+  return address;
+}
+
+void printTLBStats() {
+  TLBStats *s = &tlb.stats;
+
+  printf("\nTLB statistics (page size %u bytes)\n", (uint32_t)PAGE_SIZE);
+  printf("L1 TLB; Hits %u; Misses %u\n", s->L1Hits, s->L1Misses);
+  printf("L2 TLB; Hits %u; Misses %u\n", s->L2Hits, s->L2Misses);
+  printf("Page walks %u; Page table accesses %u\n", s->Walks, s->WalkAccesses);
+  printf("Page-walk cache; Hits %u; Misses %u\n", s->PWCHits, s->PWCMisses);
+}
@@ -0,0 +1,102 @@
+#ifndef TLB_H
+#define TLB_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "../Cache.h"
+
+#ifdef LATENCY_HISTOGRAM
+#include "../Latency/Latency.h"
+#endif
+
+#ifdef REGION_STATS
+#include "../Region/Region.h"
+#endif
+
+#define PTE_SIZE 4 // in bytes // Size of a page table entry
+#define PTE_PRESENT 0x1 // The entry maps a page or points to a next level table
+#define PTE_HUGE 0x80 // The entry maps a page directly instead of pointing to a next level table
+#define PTE_FRAME_MASK 0xFFFFF000 // Bits of the entry holding the frame / next level table address
+
+#define PT_LEVELS 3 // 1G entries -> 2M entries -> 4K entries
+#define PT_TABLE_SIZE PAGE_SIZE_4K // in bytes // Every table is allocated in its own 4K frame
+#define PT_REGION_SIZE (3 * PT_TABLE_SIZE) // in bytes // Room for the page tables at the top of DRAM
+#define PT_BASE (DRAM_SIZE - PT_REGION_SIZE) // The root table lives at the start of the region
+#define VM_MAPPED_SIZE PT_BASE // Virtual addresses from here up fault, so programs cannot reach the page tables
+
+#if PAGE_SIZE == PAGE_SIZE_4K
+#define PAGE_SHIFT 12
+#define PT_LEAF_LEVEL 2 // The level whose entries map pages of PAGE_SIZE
+#elif PAGE_SIZE == PAGE_SIZE_2M
+#define PAGE_SHIFT 21
+#define PT_LEAF_LEVEL 1
+#elif PAGE_SIZE == PAGE_SIZE_1G
+#define PAGE_SHIFT 30
+#define PT_LEAF_LEVEL 0
+#else
+#error "PAGE_SIZE must be one of PAGE_SIZE_4K, PAGE_SIZE_2M or PAGE_SIZE_1G"
+#endif
+
+#define TLB_L1_SETS (TLB_L1_ENTRIES / TLB_L1_ASSOCIATIVITY)
+#define TLB_L2_SETS (TLB_L2_ENTRIES / TLB_L2_ASSOCIATIVITY)
+
+/*********************** TLB *************************/
+
+void initTLB(); // Flushes the TLBs and the page-walk cache, building the page tables on first use
+uint32_t translateAddress(uint32_t); // Translates a virtual byte address into a physical byte address
+void printTLBStats(); // Prints the per-level TLB and page walk counters
+
+/* Provided by the cache hierarchy: reads the page table entry at a physical byte address through the levels below L1 */
+void accessPageTable(uint32_t, uint8_t *);
+
+typedef struct TLBEntry {
+  uint8_t Valid;
+  uint32_t Tag; // virtual page number / number of sets
+  uint32_t Frame; // physical page number
+  uint32_t Time;
+} TLBEntry;
+
+typedef struct TLBL1 {
+  TLBEntry Entries[TLB_L1_SETS][TLB_L1_ASSOCIATIVITY];
+} TLBL1;
+
+typedef struct TLBL2 {
+  TLBEntry Entries[TLB_L2_SETS][TLB_L2_ASSOCIATIVITY];
+} TLBL2;
+
+typedef struct PWCEntry {
+  uint8_t Valid;
+  uint8_t Level; // page table level the entry was read from
+  uint32_t Tag; // virtual address bits that select the entry
+  uint32_t Entry; // the cached page table entry
+  uint32_t Time;
+} PWCEntry;
+
+typedef struct PageWalkCache {
+  PWCEntry Entries[PWC_ENTRIES];
+} PageWalkCache;
+
+typedef struct TLBStats {
+  uint32_t L1Hits;
+  uint32_t L1Misses;
+  uint32_t L2Hits;
+  uint32_t L2Misses;
+  uint32_t Walks;
+  uint32_t WalkAccesses; // page table entries read through the memory hierarchy
+  uint32_t PWCHits;
+  uint32_t PWCMisses;
+} TLBStats;
+
+typedef struct TLB {
+  uint32_t init;
+  uint32_t tablesBuilt;
+  uint32_t clock; // LRU counter shared by both TLB levels and the page-walk cache
+  TLBL1 L1;
+  TLBL2 L2;
+  PageWalkCache PWC;
+  TLBStats stats;
+} TLB;
+
+#endif
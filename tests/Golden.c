@@ -0,0 +1,46 @@
+#include "Golden.h"
+
+int writeGolden(const char *path, const Golden *golden) {
+  uint32_t header[2] = {GOLDEN_VERSION, golden->count};
+  FILE *file = fopen(path, "wb");
+
+  if (file == NULL)
+    return -1;
+
+  int status = fwrite(GOLDEN_MAGIC, 4, 1, file) == 1 && fwrite(header, sizeof(header), 1, file) == 1 &&
+               fwrite(golden->Records, sizeof(GoldenRecord), golden->count, file) == golden->count;
+  return (fclose(file) == 0 && status) ? 0 : -1;
+}
+
+Golden *loadGolden(const char *path) {
+  char magic[4];
+  uint32_t header[2];
+  FILE *file = fopen(path, "rb");
+
+  if (file == NULL)
+    return NULL;
+
+  if (fread(magic, 4, 1, file) != 1 || memcmp(magic, GOLDEN_MAGIC, 4) != 0 || fread(header, sizeof(header), 1, file) != 1 ||
+      header[0] != GOLDEN_VERSION) {
+    fclose(file);
+    return NULL;
+  }
+
+  Golden *golden = malloc(sizeof(Golden));
+  golden->count = header[1];
+  golden->Records = malloc((size_t)golden->count * sizeof(GoldenRecord) + 1);
+
+  if (fread(golden->Records, sizeof(GoldenRecord), golden->count, file) != golden->count || fgetc(file) != EOF) {
+    fclose(file);
+    freeGolden(golden);
+    return NULL;
+  }
+
+  fclose(file);
+  return golden;
+}
+
+void freeGolden(Golden *golden) {
+  free(golden->Records);
+  free(golden);
+}
@@ -0,0 +1,41 @@
+#ifndef GOLDEN_H
+#define GOLDEN_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "../Cache.h"
+
+/*
+Binary golden files. GoldenConvert turns a tests/results_*.txt file into a
+flat array of fixed-size records, so the regression harness loads it with a
+single fread and compares every access against it without parsing text
+
+Layout: "CGLD", version, record count (uint32_t each), then the records
+*/
+
+#define GOLDEN_MAGIC "CGLD"
+#define GOLDEN_VERSION 1
+
+#define GOLDEN_OP_WRITE MODE_WRITE
+#define GOLDEN_OP_READ MODE_READ
+#define GOLDEN_OP_RESET 2 // "Number of words" line: time and cache are reset, Value holds the number of words
+
+typedef struct GoldenRecord {
+  uint32_t Op;
+  uint32_t Address;
+  uint32_t Value; // word read or written
+  uint32_t Time; // getTime() after the access
+} GoldenRecord;
+
+typedef struct Golden {
+  uint32_t count;
+  GoldenRecord *Records;
+} Golden;
+
+int writeGolden(const char *, const Golden *); // 0 on success
+Golden *loadGolden(const char *); // NULL if the file is missing or malformed
+void freeGolden(Golden *);
+
+#endif
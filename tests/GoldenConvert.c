@@ -0,0 +1,55 @@
+#include "Golden.h"
+
+int main(int argc, char **argv) {
+  /*
+  Converts the text output of SimpleProgram (the format of tests/results_*.txt)
+  into a binary golden file. Every "Number of words" line starts a new run, which
+  is recorded as a GOLDEN_OP_RESET
+
+  usage: GoldenConvert <results.txt> <output.golden>
+  */
+
+  char line[256];
+  uint32_t capacity = 1024;
+  GoldenRecord record;
+  Golden golden = {0, malloc(capacity * sizeof(GoldenRecord))};
+
+  if (argc != 3) {
+    fprintf(stderr, "usage: %s <results.txt> <output.golden>\n", argv[0]);
+    return -1;
+  }
+
+  FILE *input = fopen(argv[1], "r");
+  if (input == NULL) {
+    fprintf(stderr, "cannot open %s\n", argv[1]);
+    return -1;
+  }
+
+  while (fgets(line, sizeof(line), input) != NULL) {
+    memset(&record, 0, sizeof(record));
+    if (sscanf(line, "Number of words: %u", &record.Value) == 1)
+      record.Op = GOLDEN_OP_RESET;
+    else if (sscanf(line, "Write; Address %u; Value %u; Time %u", &record.Address, &record.Value, &record.Time) == 3)
+      record.Op = GOLDEN_OP_WRITE;
+    else if (sscanf(line, "Read; Address %u; Value %u; Time %u", &record.Address, &record.Value, &record.Time) == 3)
+      record.Op = GOLDEN_OP_READ;
+    else
+      continue;
+
+    if (golden.count == capacity) {
+      capacity *= 2;
+      golden.Records = realloc(golden.Records, capacity * sizeof(GoldenRecord));
+    }
+    golden.Records[golden.count++] = record;
+  }
+  fclose(input);
+
+  if (writeGolden(argv[2], &golden) != 0) {
+    fprintf(stderr, "cannot write %s\n", argv[2]);
+    return -1;
+  }
+
+  printf("%s: %u records\n", argv[2], golden.count);
+  free(golden.Records);
+  return 0;
+}
@@ -0,0 +1,189 @@
+#include "../MRC/Shards.h"
+
+/*
+Checks the SHARDS estimator against exact LRU stack distances. Streams over the
+DRAM are fed through sampleMRC with every block sampled (what MRC=exact does),
+which must give the exact curve. Streams over CHECK_SPACE blocks, more than
+MRC_SAMPLES can track, start the same way, so the threshold has to be lowered
+and blocks evicted; each of them is estimated with CHECK_SETS disjoint sample
+sets (the blocks are shifted by a multiple of CHECK_SPACE), and both every set
+and their average curve are compared with the exact one
+
+usage: MRCCheck
+*/
+
+#define CHECK_BLOCKS (DRAM_SIZE / BLOCK_SIZE) // every block the simulator can reach
+#define CHECK_SPACE (2 * MRC_SAMPLES) // blocks of the large footprint streams, the rate ends near 1/2
+#define CHECK_ACCESSES 1000000
+#define CHECK_SETS 16
+#define CHECK_MIN_SIZE 16 // smallest size compared once sampled, scaled distances do not resolve sizes below ~8 / R
+#define CHECK_EXACT_ERROR 0.001 // mean absolute error allowed with every block sampled
+#define CHECK_SAMPLED_ERROR 0.05 // with a lowered rate, for one sample set
+#define CHECK_BIAS_ERROR 0.005 // and for the curve averaged over the sample sets
+
+static uint32_t stream[CHECK_ACCESSES];
+static uint32_t lastAccess[CHECK_SPACE]; // 1 + index of the previous access to every block, 0 if none
+static uint32_t fenwick[CHECK_ACCESSES + 1]; // one mark per block, at its previous access
+static double exact[MRC_BUCKETS + 1];
+static double average[MRC_BUCKETS + 1];
+
+static void buildStream(int kind) {
+  srand(kind + 1);
+  for (uint32_t i = 0; i < CHECK_ACCESSES; i++) {
+    switch (kind) {
+      case 0: // uniform over the whole DRAM
+        stream[i] = rand() % CHECK_BLOCKS;
+        break;
+      case 1: // 90% of the accesses to a hot set of 64 blocks
+        stream[i] = rand() % 10 ? rand() % 64 : rand() % CHECK_BLOCKS;
+        break;
+      case 2: // strided sweep (stride 144 reaches 64 blocks) interleaved with a sequential loop over 300 blocks
+        stream[i] = i % 4 ? (i * 144) % CHECK_BLOCKS : CHECK_BLOCKS - 1 - (i / 4) % 300;
+        break;
+      case 3: // 80% of the accesses to a hot set of 512 blocks, the others scan the whole space
+        stream[i] = rand() % 10 < 8 ? (uint32_t)rand() % 512 : 512 + i % (CHECK_SPACE - 512);
+        break;
+      case 4: { // skewed, block = space * u^4 for a uniform u
+        double u = (double)rand() / RAND_MAX;
+        stream[i] = u * u * u * u * (CHECK_SPACE - 1);
+        break;
+      }
+      default: // loop over 700 blocks, every fourth access anywhere else
+        stream[i] = i % 4 ? (i / 4) % 700 : 700 + (uint32_t)rand() % (CHECK_SPACE - 700);
+        break;
+    }
+  }
+}
+
+static void fenwickAdd(uint32_t position, int32_t delta) {
+  for (; position <= CHECK_ACCESSES; position += position & -position)
+    fenwick[position] += delta;
+}
+
+static uint32_t fenwickPrefix(uint32_t position) {
+  uint32_t sum = 0;
+  for (; position > 0; position -= position & -position)
+    sum += fenwick[position];
+  return sum;
+}
+
+static void exactCurve() {
+  /* The reuse distance of an access is the number of blocks whose last access falls after the previous one of its block */
+
+  static double distances[MRC_BUCKETS + 1];
+  double misses = 0;
+
+  memset(distances, 0, sizeof(distances));
+  memset(lastAccess, 0, sizeof(lastAccess));
+  memset(fenwick, 0, sizeof(fenwick));
+
+  for (uint32_t i = 0; i < CHECK_ACCESSES; i++) {
+    uint32_t previous = lastAccess[stream[i]];
+
+    if (previous == 0) {
+      misses++;
+    } else {
+      uint32_t distance = fenwickPrefix(i) - fenwickPrefix(previous);
+      distances[distance < MRC_BUCKETS ? distance : MRC_BUCKETS]++;
+      fenwickAdd(previous, -1);
+    }
+    lastAccess[stream[i]] = i + 1;
+    fenwickAdd(i + 1, 1);
+  }
+
+  for (int size = MRC_BUCKETS; size >= 0; size--) {
+    misses += distances[size];
+    exact[size] = misses / CHECK_ACCESSES;
+  }
+}
+
+static double curveError(const double *curve, uint32_t smallest, double *worst, uint32_t *worstSize) {
+  double total = 0;
+
+  *worst = 0;
+  for (uint32_t size = smallest; size <= MRC_BUCKETS; size++) {
+    double error = curve[size] - exact[size];
+    error = error < 0 ? -error : error;
+    total += error;
+    if (error > *worst) {
+      *worst = error;
+      *worstSize = size;
+    }
+  }
+  return total / (MRC_BUCKETS - smallest + 1);
+}
+
+static void estimate(uint32_t offset) {
+  /* Runs the stream through the estimator starting with every block sampled, blocks shifted by offset */
+
+  initMRC();
+  mrc.threshold = MRC_MODULUS;
+
+  for (uint32_t i = 0; i < CHECK_ACCESSES; i++)
+    sampleMRC((stream[i] + offset) * BLOCK_SIZE);
+  publishMRC();
+}
+
+static int checkExact(const char *name) {
+  double worst;
+  uint32_t worstSize = 1;
+
+  estimate(0);
+  double error = curveError(mrc.Published, 1, &worst, &worstSize);
+
+  printf("%s; Every block; Mean error %.4f; Worst %.4f at %u blocks (exact %.4f)%s\n", name, error, worst, worstSize,
+         exact[worstSize], error > CHECK_EXACT_ERROR ? "; FAILED" : "");
+  return error > CHECK_EXACT_ERROR;
+}
+
+static int checkSampled(const char *name) {
+  double worst, largest = 0, lowest = 1, highest = 0;
+  uint32_t worstSize = CHECK_MIN_SIZE;
+  int failed = 0;
+
+  memset(average, 0, sizeof(average));
+  for (uint32_t set = 0; set < CHECK_SETS; set++) {
+    estimate(set * CHECK_SPACE);
+
+    double rate = (double)mrc.threshold / MRC_MODULUS;
+    double error = curveError(mrc.Published, CHECK_MIN_SIZE, &worst, &worstSize);
+
+    if (mrc.count != MRC_SAMPLES || rate > 0.75) { // the threshold was never lowered
+      printf("%s; Set %u; Rate %.4f with %u blocks tracked; FAILED\n", name, set, rate, mrc.count);
+      failed = 1;
+    }
+    if (error > CHECK_SAMPLED_ERROR) {
+      printf("%s; Set %u; Rate %.4f; Mean error %.4f; Worst %.4f at %u blocks (exact %.4f); FAILED\n", name, set, rate,
+             error, worst, worstSize, exact[worstSize]);
+      failed = 1;
+    }
+
+    largest = error > largest ? error : largest;
+    lowest = rate < lowest ? rate : lowest;
+    highest = rate > highest ? rate : highest;
+    for (uint32_t size = 0; size <= MRC_BUCKETS; size++)
+      average[size] += mrc.Published[size] / CHECK_SETS;
+  }
+
+  double error = curveError(average, CHECK_MIN_SIZE, &worst, &worstSize);
+  failed |= error > CHECK_BIAS_ERROR;
+  printf("%s; Rate %.4f to %.4f; Largest mean error %.4f; Mean error of the average %.4f; Worst %.4f at %u blocks (exact %.4f)%s\n",
+         name, lowest, highest, largest, error, worst, worstSize, exact[worstSize], failed ? "; FAILED" : "");
+  return failed;
+}
+
+int main() {
+  static const char *names[] = {"uniform", "hot set", "strided", "hot set and scan", "skewed", "loop"};
+  int failed = 0;
+
+  for (int kind = 0; kind < 6; kind++) {
+    buildStream(kind);
+    exactCurve();
+    if (kind < 3)
+      failed |= checkExact(names[kind]);
+    else
+      failed |= checkSampled(names[kind]);
+  }
+
+  return failed;
+}
@@ -0,0 +1,105 @@
+#include "Reference.h"
+
+static ReferenceLevel levels[REFERENCE_MAX_LEVELS];
+static uint32_t levelCount;
+static uint8_t memory[DRAM_SIZE];
+static uint32_t clock;
+static uint64_t uses; // LRU counter, bumped on every line access
+
+static void copyBytes(uint8_t *to, const uint8_t *from, uint32_t bytes) {
+  for (uint32_t i = 0; i < bytes; i++)
+    to[i] = from[i];
+}
+
+static void buildLevel(ReferenceLevel *level, uint32_t size, uint32_t ways, uint32_t readTime, uint32_t writeTime) {
+  level->ways = ways;
+  level->sets = size / (BLOCK_SIZE * ways);
+  level->readTime = readTime;
+  level->writeTime = writeTime;
+  free(level->Lines);
+  level->Lines = calloc(level->sets * ways, sizeof(ReferenceLine));
+}
+
+void initReference(uint32_t l2Ways) {
+  levelCount = 0;
+  buildLevel(&levels[levelCount++], L1_SIZE, 1, L1_READ_TIME, L1_WRITE_TIME);
+  if (l2Ways != 0)
+    buildLevel(&levels[levelCount++], L2_SIZE, l2Ways, L2_READ_TIME, L2_WRITE_TIME);
+
+  memset(memory, 0, sizeof(memory));
+  resetReference();
+}
+
+void resetReference() {
+  for (uint32_t i = 0; i < levelCount; i++)
+    memset(levels[i].Lines, 0, levels[i].sets * levels[i].ways * sizeof(ReferenceLine));
+  clock = 0;
+}
+
+static void accessLevel(uint32_t depth, uint32_t address, uint8_t *data, uint32_t bytes, uint32_t mode) {
+  if (depth == levelCount) { // DRAM
+    if (address > DRAM_SIZE - bytes) {
+      fprintf(stderr, "reference: address %u is outside the DRAM\n", address);
+      exit(-1);
+    }
+    if (mode == MODE_READ) {
+      copyBytes(data, &memory[address], bytes);
+      clock += DRAM_READ_TIME;
+    } else {
+      copyBytes(&memory[address], data, bytes);
+      clock += DRAM_WRITE_TIME;
+    }
+    return;
+  }
+
+  ReferenceLevel *level = &levels[depth];
+  uint32_t block = address / BLOCK_SIZE;
+  uint32_t index = block % level->sets;
+  uint32_t Tag = block / level->sets;
+  ReferenceLine *Set = &level->Lines[index * level->ways];
+  ReferenceLine *Line = NULL;
+
+  for (uint32_t way = 0; way < level->ways; way++) {
+    if (Set[way].Valid && Set[way].Tag == Tag)
+      Line = &Set[way];
+  }
+
+  if (Line == NULL) { // miss: first invalid way, otherwise the least recently used one
+    for (uint32_t way = 0; way < level->ways && Line == NULL; way++) {
+      if (!Set[way].Valid)
+        Line = &Set[way];
+    }
+    if (Line == NULL) {
+      Line = &Set[0];
+      for (uint32_t way = 1; way < level->ways; way++) {
+        if (Set[way].LastUse < Line->LastUse)
+          Line = &Set[way];
+      }
+    }
+
+    if (Line->Valid && Line->Dirty)
+      accessLevel(depth + 1, (Line->Tag * level->sets + index) * BLOCK_SIZE, Line->Data, BLOCK_SIZE, MODE_WRITE);
+
+    accessLevel(depth + 1, block * BLOCK_SIZE, Line->Data, BLOCK_SIZE, MODE_READ);
+    Line->Valid = 1;
+    Line->Dirty = 0;
+    Line->Tag = Tag;
+  }
+
+  Line->LastUse = ++uses;
+
+  if (mode == MODE_READ) {
+    copyBytes(data, &Line->Data[address % BLOCK_SIZE], bytes);
+    clock += level->readTime;
+  } else {
+    copyBytes(&Line->Data[address % BLOCK_SIZE], data, bytes);
+    clock += level->writeTime;
+    Line->Dirty = 1;
+  }
+}
+
+void referenceRead(uint32_t address, uint8_t *data) { accessLevel(0, address, data, WORD_SIZE, MODE_READ); }
+
+void referenceWrite(uint32_t address, uint8_t *data) { accessLevel(0, address, data, WORD_SIZE, MODE_WRITE); }
+
+uint32_t referenceTime() { return clock; }
@@ -0,0 +1,45 @@
+#ifndef REFERENCE_H
+#define REFERENCE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "../Cache.h"
+
+/*
+Reference model for differential testing. It simulates the same hierarchy as
+the C variants and Template/CacheLevel.hpp, with the geometry chosen at run
+time and nothing optimized: every level is a plain array of lines searched
+linearly, LRU uses one global access counter, data is moved a byte at a time.
+Its names are prefixed so it links next to the engine under test
+
+Timing: an access to a level costs its read or write time whether it hits or
+misses, plus the dirty victim write-back and then the fill from the level below
+*/
+
+#define REFERENCE_MAX_LEVELS 2
+
+void initReference(uint32_t); // Builds L1 and, for 1 or 2 ways, an L2 of that associativity; clears the DRAM
+void resetReference(); // Like resetTime + initCache: invalidates every line, the DRAM keeps its contents
+void referenceRead(uint32_t, uint8_t *);
+void referenceWrite(uint32_t, uint8_t *);
+uint32_t referenceTime();
+
+typedef struct ReferenceLine {
+  uint32_t Valid;
+  uint32_t Dirty;
+  uint32_t Tag;
+  uint64_t LastUse;
+  uint8_t Data[BLOCK_SIZE];
+} ReferenceLine;
+
+typedef struct ReferenceLevel {
+  uint32_t sets;
+  uint32_t ways;
+  uint32_t readTime;
+  uint32_t writeTime;
+  ReferenceLine *Lines; // sets * ways lines, a set is contiguous
+} ReferenceLevel;
+
+#endif
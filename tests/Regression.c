@@ -0,0 +1,230 @@
+#include "../SimpleCache.h"
+#include "Golden.h"
+#include "Reference.h"
+
+/*
+Regression harness, linked with the hierarchy under test (a C variant or the
+templated one). It replays a binary golden file access by access and compares
+the value and time of each one, then optionally runs a random access stream
+against the reference model of the same shape. Both stop at the first
+divergence and print the accesses leading to it
+
+usage: Regression [-x record] [-r l2ways] [-d accesses] [-a limit] [-w limit] [-X access] <golden>
+  -x  the engine is known to first diverge from this golden at this record: fail if it diverges anywhere else or matches
+  -r  also check the reference model with this L2 associativity (0 = no L2) against the golden
+  -d  then compare engine and reference on this many random accesses (needs -r)
+  -a  random accesses stay below this address (DRAM_SIZE by default)
+  -w  random writes stay below this address (-a by default)
+A limit is a byte count, l1 for L1_SIZE or l1lines for L1_SIZE / BLOCK_SIZE (the
+number of L1 lines, as a byte address: where an address first gets a nonzero L1 tag)
+  -X  the random stream is known to first diverge at this access, pinned like -x
+*/
+
+#define REGRESSION_CONTEXT 4 // accesses printed before a divergence
+#define REGRESSION_SEED 1
+
+static const char *opNames[] = {"Write", "Read"};
+
+static void printRecord(const char *prefix, uint64_t number, const GoldenRecord *record) {
+  printf("%s #%llu %s; Address %u; Value %u; Time %u\n", prefix, (unsigned long long)number, opNames[record->Op],
+         record->Address, record->Value, record->Time);
+}
+
+static uint32_t parseLimit(const char *text) {
+  if (strcmp(text, "l1") == 0)
+    return L1_SIZE;
+  if (strcmp(text, "l1lines") == 0)
+    return L1_SIZE / BLOCK_SIZE;
+  return strtoul(text, NULL, 10);
+}
+
+static void accessEngine(GoldenRecord *record) { // Performs the access of record, filling in Value and Time
+  if (record->Op == GOLDEN_OP_READ)
+    read(record->Address, (uint8_t *)(&record->Value));
+  else
+    write(record->Address, (uint8_t *)(&record->Value));
+  record->Time = getTime();
+}
+
+static void accessReference(GoldenRecord *record) {
+  if (record->Op == GOLDEN_OP_READ)
+    referenceRead(record->Address, (uint8_t *)(&record->Value));
+  else
+    referenceWrite(record->Address, (uint8_t *)(&record->Value));
+  record->Time = referenceTime();
+}
+
+static int checkGolden(const Golden *golden, const char *path, int reference) {
+  /* Returns the index of the first diverging record, -1 if every record matches */
+
+  uint32_t words = 0, run = 0; // current run and its access count, for the report
+
+  resetTime();
+  initCache();
+
+  for (uint32_t i = 0; i < golden->count; i++) {
+    const GoldenRecord *Expected = &golden->Records[i];
+    GoldenRecord Engine = *Expected, Reference = *Expected;
+    const char *who = NULL;
+    GoldenRecord *Got = NULL;
+
+    if (Expected->Op == GOLDEN_OP_RESET) {
+      resetTime();
+      initCache();
+      if (reference)
+        resetReference();
+      words = Expected->Value;
+      run = 0;
+      continue;
+    }
+    run++;
+
+    if (Expected->Op == GOLDEN_OP_READ)
+      Engine.Value = Reference.Value = 0;
+
+    accessEngine(&Engine);
+    if (Engine.Value != Expected->Value || Engine.Time != Expected->Time) {
+      who = "engine";
+      Got = &Engine;
+    }
+
+    if (reference) {
+      accessReference(&Reference);
+      if (Got == NULL && (Reference.Value != Expected->Value || Reference.Time != Expected->Time)) {
+        who = "reference model";
+        Got = &Reference;
+      }
+    }
+
+    if (Got != NULL) {
+      printf("%s diverges from %s at record %u (access %u of the run with %u words)\n", who, path, i, run, words);
+      for (uint32_t j = i > REGRESSION_CONTEXT ? i - REGRESSION_CONTEXT : 0; j < i; j++) {
+        if (golden->Records[j].Op != GOLDEN_OP_RESET)
+          printRecord("   ", j, &golden->Records[j]);
+      }
+      printRecord("exp", i, Expected);
+      printRecord("got", i, Got);
+      return i;
+    }
+  }
+  return -1;
+}
+
+static int64_t checkReference(uint64_t accesses, uint32_t limit, uint32_t writeLimit) {
+  /*
+  Random reads and writes below limit (writes below writeLimit), engine and reference
+  side by side. Returns the index of the first diverging access, -1 if all match
+  */
+
+  GoldenRecord Context[REGRESSION_CONTEXT];
+
+  srand(REGRESSION_SEED);
+  resetTime();
+  initCache();
+  resetReference();
+
+  for (uint64_t i = 0; i < accesses; i++) {
+    GoldenRecord Engine, Reference;
+
+    Engine.Op = rand() % 2;
+    Engine.Address = (uint32_t)rand() % (Engine.Op == GOLDEN_OP_READ ? limit : writeLimit);
+    Engine.Address -= Engine.Address % WORD_SIZE;
+    Engine.Value = Engine.Op == GOLDEN_OP_READ ? 0 : (uint32_t)rand();
+    Reference = Engine;
+
+    accessEngine(&Engine);
+    accessReference(&Reference);
+
+    if (Engine.Value != Reference.Value || Engine.Time != Reference.Time) {
+      printf("engine diverges from the reference model at random access %llu (seed %d)\n", (unsigned long long)i,
+             REGRESSION_SEED);
+      for (uint64_t j = i > REGRESSION_CONTEXT ? i - REGRESSION_CONTEXT : 0; j < i; j++)
+        printRecord("   ", j, &Context[j % REGRESSION_CONTEXT]);
+      printRecord("ref", i, &Reference);
+      printRecord("got", i, &Engine);
+      return i;
+    }
+    Context[i % REGRESSION_CONTEXT] = Engine;
+  }
+  return -1;
+}
+
+static int checkPinned(const char *program, int64_t divergence, int64_t known, const char *what) {
+  /* Returns 0 when a known divergence is exactly where it was pinned */
+
+  if (divergence == known) {
+    printf("%s: known divergence at %s %lld\n", program, what, (long long)known);
+    return 0;
+  }
+  if (divergence == -1)
+    printf("%s: matches, but was expected to diverge at %s %lld\n", program, what, (long long)known);
+  else
+    printf("%s: diverges at %s %lld, but was expected to diverge at %lld\n", program, what, (long long)divergence,
+           (long long)known);
+  return 1;
+}
+
+int main(int argc, char **argv) {
+  int arg = 1, l2Ways = -1;
+  int64_t knownRecord = -1, knownAccess = -1;
+  uint64_t accesses = 0;
+  uint32_t limit = DRAM_SIZE, writeLimit = 0;
+
+  while (argc > arg && argv[arg][0] == '-') {
+    if (strcmp(argv[arg], "-x") == 0 && argc > arg + 1)
+      knownRecord = atoll(argv[++arg]);
+    else if (strcmp(argv[arg], "-X") == 0 && argc > arg + 1)
+      knownAccess = atoll(argv[++arg]);
+    else if (strcmp(argv[arg], "-r") == 0 && argc > arg + 1)
+      l2Ways = atoi(argv[++arg]);
+    else if (strcmp(argv[arg], "-d") == 0 && argc > arg + 1)
+      accesses = strtoull(argv[++arg], NULL, 10);
+    else if (strcmp(argv[arg], "-a") == 0 && argc > arg + 1)
+      limit = parseLimit(argv[++arg]);
+    else if (strcmp(argv[arg], "-w") == 0 && argc > arg + 1)
+      writeLimit = parseLimit(argv[++arg]);
+    else
+      break;
+    arg++;
+  }
+  if (writeLimit == 0)
+    writeLimit = limit;
+
+  if (argc != arg + 1 || l2Ways < -1 || l2Ways > 2 || (accesses != 0 && l2Ways == -1) || limit < WORD_SIZE ||
+      limit > DRAM_SIZE || writeLimit < WORD_SIZE || writeLimit > limit) {
+    fprintf(stderr, "usage: %s [-x record] [-r l2ways] [-d accesses] [-a limit] [-w limit] [-X access] <golden>\n", argv[0]);
+    return -1;
+  }
+
+  Golden *golden = loadGolden(argv[arg]);
+  if (golden == NULL) {
+    fprintf(stderr, "cannot load golden %s\n", argv[arg]);
+    return -1;
+  }
+
+  if (l2Ways != -1)
+    initReference(l2Ways);
+
+  int64_t divergence = checkGolden(golden, argv[arg], l2Ways != -1);
+  uint32_t count = golden->count;
+  freeGolden(golden);
+
+  if (knownRecord != -1) // nothing after a divergence is checked, so a pinned run ends here
+    return checkPinned(argv[0], divergence, knownRecord, "record");
+
+  if (divergence != -1)
+    return 1;
+  printf("%s: %u records match %s\n", argv[0], count, argv[arg]);
+
+  if (accesses != 0) {
+    divergence = checkReference(accesses, limit, writeLimit);
+    if (knownAccess != -1)
+      return checkPinned(argv[0], divergence, knownAccess, "random access");
+    if (divergence != -1)
+      return 1;
+    printf("%s: %llu random accesses below %u (writes below %u) match the reference model\n", argv[0],
+           (unsigned long long)accesses, limit, writeLimit);
+  }
+
+  return 0;
+}
@@ -0,0 +1,199 @@
+#include "../Trace/Trace.h"
+
+/*
+Round trip of the compressed trace format. A random (op, address) stream with
+sweeps, large negative deltas, jumps across the whole address space and resets,
+spanning more blocks than the reader has slots, is written with the given codec
+and read back with one and several decoder threads, record by record. Copies of
+the trace cut inside the file header, the last block header and the last payload,
+or with a trailing byte, must not open, and a block whose header lies about its
+size must stop the replay with an error exactly at that block
+
+usage: TraceCheck [-z | -l]
+*/
+
+#define CHECK_RECORDS (40 * TRACE_BLOCK_RECORDS + 1234)
+#define CHECK_FLUSH (CHECK_RECORDS / 3) // a block is ended early here
+#define CHECK_CORRUPT_BLOCK 20 // block whose header is corrupted
+#define CHECK_PATH "tests/TraceCheck.trace"
+#define CHECK_DAMAGED_PATH "tests/TraceCheck.damaged.trace"
+
+static TraceRecord stream[CHECK_RECORDS];
+
+static uint32_t randomWord() { return ((uint32_t)rand() << 16) ^ (uint32_t)rand(); }
+
+static void buildStream() {
+  uint32_t previous[2] = {0, 0};
+
+  srand(1);
+  for (uint32_t i = 0; i < CHECK_RECORDS; i++) {
+    uint32_t op = rand() % 2, kind = rand() % 16;
+    uint32_t address = previous[op];
+
+    if (rand() % 500 == 0) {
+      stream[i].op = TRACE_OP_RESET;
+      stream[i].address = 0;
+      continue;
+    }
+
+    if (kind < 8) // sweep
+      address += WORD_SIZE;
+    else if (kind < 10) // small step either way
+      address += rand() % 129 - 64;
+    else if (kind < 12) // large negative delta
+      address -= randomWord() % 0x80000000u;
+    else if (kind < 14) // from one end of the address space to the other
+      address = address < 0x80000000u ? 0xFFFFFFFFu - rand() % 4 : (uint32_t)rand() % 4;
+    else
+      address = randomWord();
+
+    stream[i].op = op;
+    stream[i].address = address;
+    previous[op] = address;
+  }
+}
+
+static int writeTrace(uint32_t codec) {
+  TraceWriter *writer = openTraceWriter(CHECK_PATH, codec);
+  int status = 0;
+
+  if (writer == NULL) {
+    printf("cannot create %s with codec %u (is the codec compiled in?)\n", CHECK_PATH, codec);
+    return -1;
+  }
+
+  for (uint32_t i = 0; i < CHECK_RECORDS && status == 0; i++) {
+    status = traceRecord(writer, stream[i].op, stream[i].address);
+    if (i == CHECK_FLUSH && status == 0)
+      status = flushTraceWriter(writer);
+  }
+
+  printf("%llu records, %llu bytes encoded, %llu bytes stored\n", (unsigned long long)writer->totalRecords + writer->count,
+         (unsigned long long)writer->totalEncoded, (unsigned long long)writer->totalStored);
+  if (closeTraceWriter(writer) != 0)
+    status = -1;
+  return status;
+}
+
+static int readTrace(const char *path, uint32_t threads, int64_t failAt) {
+  /* Compares the records of the trace with the stream, which must end at CHECK_RECORDS or fail after failAt records */
+
+  TraceReader *reader = openTraceReader(path, threads);
+  TraceRecord record;
+  uint64_t count = 0;
+  int status;
+
+  if (reader == NULL) {
+    printf("%s; %u threads; cannot open; FAILED\n", path, threads);
+    return 1;
+  }
+
+  while ((status = nextTraceRecord(reader, &record)) == 1) {
+    if (count == CHECK_RECORDS || record.op != stream[count].op || record.address != stream[count].address) {
+      printf("%s; %u threads; record %llu is %u %u instead of %u %u; FAILED\n", path, threads, (unsigned long long)count,
+             record.op, record.address, stream[count].op, stream[count].address);
+      closeTraceReader(reader);
+      return 1;
+    }
+    count++;
+  }
+  closeTraceReader(reader);
+
+  if (failAt == -1 ? status != 0 || count != CHECK_RECORDS : status != -1 || count != (uint64_t)failAt) {
+    printf("%s; %u threads; ends with %d after %llu records; FAILED\n", path, threads, status, (unsigned long long)count);
+    return 1;
+  }
+  printf("%s; %u threads; %s after %llu records\n", path, threads, failAt == -1 ? "ends" : "fails", (unsigned long long)count);
+  return 0;
+}
+
+static int writeDamaged(const uint8_t *trace, long size) {
+  FILE *file = fopen(CHECK_DAMAGED_PATH, "wb");
+
+  if (file == NULL)
+    return -1;
+  if (size > 0 && fwrite(trace, 1, size, file) != (size_t)size) {
+    fclose(file);
+    return -1;
+  }
+  return fclose(file);
+}
+
+static int checkDamaged(uint32_t threads) {
+  uint8_t *trace;
+  long size, last = TRACE_FILE_HEADER_SIZE, corrupt = 0;
+  uint32_t blocks = 0, before = 0;
+  int failed = 0;
+  FILE *file = fopen(CHECK_PATH, "rb");
+
+  if (file == NULL || fseek(file, 0, SEEK_END) != 0 || (size = ftell(file)) < 0 || fseek(file, 0, SEEK_SET) != 0)
+    return 1;
+  trace = malloc(size + 1);
+  if (trace == NULL || fread(trace, 1, size, file) != (size_t)size) {
+    fclose(file);
+    free(trace);
+    return 1;
+  }
+  fclose(file);
+
+  for (long offset = TRACE_FILE_HEADER_SIZE; offset < size; blocks++) { // finds the last block and the one to corrupt
+    uint32_t count = trace[offset] | trace[offset + 1] << 8 | trace[offset + 2] << 16 | (uint32_t)trace[offset + 3] << 24;
+    uint32_t stored = trace[offset + 8] | trace[offset + 9] << 8 | trace[offset + 10] << 16 | (uint32_t)trace[offset + 11] << 24;
+
+    if (blocks == CHECK_CORRUPT_BLOCK)
+      corrupt = offset;
+    else if (blocks < CHECK_CORRUPT_BLOCK)
+      before += count;
+    last = offset;
+    offset += TRACE_BLOCK_HEADER_SIZE + stored;
+  }
+
+  static const char *names[] = {"cut in the file header", "cut in the last block header", "cut in the last payload",
+                                "with a trailing byte"};
+  long lengths[] = {TRACE_FILE_HEADER_SIZE / 2, last + 5, size - 1, size + 1};
+
+  trace[size] = 0;
+  for (int i = 0; i < 4; i++) {
+    TraceReader *reader = writeDamaged(trace, lengths[i]) == 0 ? openTraceReader(CHECK_DAMAGED_PATH, threads) : NULL;
+
+    printf("%s; %s; %s\n", CHECK_DAMAGED_PATH, names[i], reader == NULL ? "rejected" : "opens; FAILED");
+    if (reader != NULL) {
+      closeTraceReader(reader);
+      failed = 1;
+    }
+  }
+
+  trace[corrupt + 4]++; // the encoded size no longer matches the payload
+  failed |= writeDamaged(trace, size) != 0 || readTrace(CHECK_DAMAGED_PATH, threads, before);
+
+  remove(CHECK_DAMAGED_PATH);
+  free(trace);
+  return failed;
+}
+
+int main(int argc, char **argv) {
+  uint32_t codec = TRACE_CODEC_NONE;
+  int failed = 0;
+
+  if (argc == 2 && strcmp(argv[1], "-z") == 0) {
+    codec = TRACE_CODEC_ZSTD;
+  } else if (argc == 2 && strcmp(argv[1], "-l") == 0) {
+    codec = TRACE_CODEC_LZ4;
+  } else if (argc != 1) {
+    fprintf(stderr, "usage: %s [-z | -l]\n", argv[0]);
+    return -1;
+  }
+
+  buildStream();
+  if (writeTrace(codec) != 0)
+    return 1;
+
+  failed |= readTrace(CHECK_PATH, 1, -1);
+  failed |= readTrace(CHECK_PATH, 4, -1);
+  failed |= readTrace(CHECK_PATH, TRACE_MAX_THREADS, -1);
+  failed |= checkDamaged(1);
+  failed |= checkDamaged(TRACE_MAX_THREADS);
+
+  remove(CHECK_PATH);
+  return failed;
+}